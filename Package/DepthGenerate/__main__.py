@@ -21,7 +21,15 @@
 import os
 import gc
 import sys
+import hashlib
 import zmq
+import json
+import time
+import queue
+import threading
+from collections import deque
+from multiprocessing import shared_memory, resource_tracker
+from concurrent.futures import ThreadPoolExecutor
 
 options = {
     "model" : "",
@@ -32,7 +40,11 @@ options = {
     "mode" : "",
     "base" : "",
     "home" : "",
-    "input" : ""
+    "input" : "",
+    "batch" : "",
+    "budget" : "",
+    "idle" : "",
+    "tile" : ""
 }
 
 print("Starting DepthGenerate")
@@ -50,8 +62,8 @@ try:
 except ValueError:
     print ("Invalid Depth Model. Default to 0.")
     depth_model = 0
-if depth_model < 0 or depth_model > 2:
-    print ("Valid Depth Model 0 to 2. Default to 0.")
+if depth_model < 0 or depth_model > 3:
+    print ("Valid Depth Model 0 to 3. Default to 0.")
     depth_model = 0
 
 try:
@@ -79,14 +91,38 @@ try:
     app_mode = int(options["mode"])
 except ValueError:
     app_mode = 0
-if app_mode < 0 or app_mode > 2:
+if app_mode < 0 or app_mode > 4 or app_mode == 3:
     app_mode = 0
 
+try:
+    max_batch = int(options["batch"])
+except ValueError:
+    max_batch = 8
+if max_batch < 1:
+    max_batch = 1
+
+try:
+    memory_budget = int(options["budget"])
+except ValueError:
+    memory_budget = 0
+
+try:
+    idle_timeout = int(options["idle"])
+except ValueError:
+    idle_timeout = 600
+
+try:
+    tile_mode = int(options["tile"])
+except ValueError:
+    tile_mode = 1
+if tile_mode < 0 or tile_mode > 2:
+    tile_mode = 1
+
 base_dir = options["base"]
 home_dir = options["home"]
 input_name = options["input"]
 
-if not input_name:
+if not input_name and app_mode != 4:
     print("Invalid Input. Usage '--input Image.jpg'")
     sys.exit()
 if os.name == "nt":
@@ -111,13 +147,13 @@ def append_export_path(dir):
     return dir
 
 if os.path.isfile(input_name):
-    if app_mode != 2:
+    if app_mode < 2:
         app_mode = 0
     export_dir = os.path.dirname(input_name)
     export_dir = append_export_path(export_dir)
 
 elif os.path.isdir(input_name):
-    if app_mode != 2:
+    if app_mode < 2:
         app_mode = 1
     export_dir = input_name
     export_dir = append_export_path(export_dir)
@@ -125,7 +161,7 @@ elif os.path.isdir(input_name):
 send_io = options["endpoint"]
 if app_mode == 2 and send_io:
     signal_context = zmq.Context()
-    signal_control = signal_context.socket(zmq.REP)
+    signal_control = signal_context.socket(zmq.ROUTER)
     signal_control.connect(send_io)
     if not signal_control:
         sys.exit()
@@ -138,6 +174,25 @@ if app_mode == 2 and send_io:
 
         export_dir = temp_dir
 
+def get_service_settings():
+    return str(depth_model) + " " + str(depth_size) + " " + str(upscale_size) + " " + str(max_size)
+
+service_file = os.path.join(home_dir, "Service_" + get_service_settings().replace(" ", "_") + ".json")
+if app_mode == 4:
+    os.makedirs(temp_dir, exist_ok=True)
+    signal_context = zmq.Context()
+    signal_control = signal_context.socket(zmq.ROUTER)
+    signal_control.bind("tcp://127.0.0.1:*")
+    send_io = signal_control.getsockopt_string(zmq.LAST_ENDPOINT)
+    export_dir = temp_dir
+
+telemetry_io = ""
+if (app_mode == 2 and send_io) or app_mode == 4:
+    signal_telemetry = signal_context.socket(zmq.PUB)
+    signal_telemetry.setsockopt(zmq.LINGER, 0)
+    signal_telemetry.bind("tcp://127.0.0.1:*")
+    telemetry_io = signal_telemetry.getsockopt_string(zmq.LAST_ENDPOINT)
+
 if app_mode == 0 and not os.path.isfile(input_name):
     print("Invalid File:", input_name)
     sys.exit()
@@ -155,6 +210,7 @@ if (app_mode == 0 or app_mode == 1) and export_dir and not os.path.isdir(export_
 
 import cv2
 import torch
+import torch.nn.functional as F
 import numpy
 import pathlib
 import importlib
@@ -175,8 +231,8 @@ if os.name == "nt":
 DepthAnyModule = importlib.import_module("Depth-Anything-V2.depth_anything_v2.dpt")
 DepthAnythingV2 = DepthAnyModule.DepthAnythingV2
 
-encoders = [ "vits", "vitb", "vitl" ]
-labels = [ "Small", "Base", "Large" ]
+encoders = [ "vits", "vitb", "vitl", "vits" ]
+labels = [ "Small", "Base", "Large", "Progressive" ]
 device_labels = { "cuda" : "GPU Accelerated", "xpu" : "GPU Accelerated", "mps" : "GPU Accelerated", "cpu": "CPU Fallback"}
 
 model_configs = {
@@ -197,7 +253,11 @@ depth_models_url = {
     "vitl": "https://huggingface.co/depth-anything/Depth-Anything-V2-Large/resolve/main/depth_anything_v2_vitl.pth?download=true",
 }
 
+progressive = depth_model == 3 and (app_mode == 2 or app_mode == 4)
+if depth_model == 3 and not progressive:
+    depth_model = 2
 encoder = encoders[depth_model]
+refine_encoder = "vitl"
 label = labels[depth_model]
 
 export_upscale = 3840
@@ -207,22 +267,35 @@ print("DepthGenerate Started with", label, "Model - Depth:", depth_size, "- Upsc
       "- Max Size:", max_size, "- Service:", app_mode)
 
 DEVICE = "cuda" if torch.cuda.is_available() else "xpu" if torch.xpu.is_available() else "mps" if torch.backends.mps.is_available() else "cpu"
-print("Starting DepthGenerate using " + ("DirectML" if directml_available and DEVICE == "cpu" else device_labels[DEVICE]) + " Mode.")
+device_label = "DirectML" if directml_available and DEVICE == "cpu" else device_labels[DEVICE]
+print("Starting DepthGenerate using " + device_label + " Mode.")
 if directml_available and DEVICE == "cpu":
     DEVICE = torch_directml.device()
 
-model = DepthAnythingV2(**model_configs[encoder])
-depth_model_path = os.path.normpath(os.path.join(models_dir, depth_models[encoder]))
-os.makedirs(models_dir, exist_ok=True)
+def load_depth_model(name):
+    depth_net = DepthAnythingV2(**model_configs[name])
+    depth_model_path = os.path.normpath(os.path.join(models_dir, depth_models[name]))
+    os.makedirs(models_dir, exist_ok=True)
+
+    if os.path.isfile(depth_model_path):
+        depth_net.load_state_dict(torch.load(depth_model_path, weights_only=True))
+    else:
+        depth_net.load_state_dict(torch.hub.load_state_dict_from_url(depth_models_url[name], model_dir=models_dir,
+                                                                     weights_only=True))
 
-if os.path.isfile(depth_model_path):
-    model.load_state_dict(torch.load(depth_model_path, weights_only=True))
-else:
-    model.load_state_dict(torch.hub.load_state_dict_from_url(depth_models_url[encoder], model_dir=models_dir,
-                                                             weights_only=True))
+    return depth_net.to(DEVICE).eval()
 
-model = model.to(DEVICE).eval()
-nina_models = [ninasr_b0, ninasr_b0, ninasr_b0]
+model = load_depth_model(encoder)
+refine_model = None
+
+def get_refine_model():
+    global refine_model
+    if refine_model is None:
+        print("Loading Refinement Model", refine_encoder)
+        refine_model = load_depth_model(refine_encoder)
+    return refine_model
+
+nina_models = [ninasr_b0, ninasr_b0, ninasr_b0, ninasr_b0]
 
 def get_sr_model(s):
     sr_m = nina_models[depth_model](scale=s, pretrained=True)
@@ -230,8 +303,51 @@ def get_sr_model(s):
     return sr_m
 
 sr_model = { 2: None, 3: None, 4: None }
-for i in range(2, 5):
-    sr_model[i] = get_sr_model(i)
+sr_lock = threading.Lock()
+sr_idle_timeout = 120
+sr_pressure_ratio = 0.1
+sr_pressure_memory = 1024
+sr_last_used = 0.0
+
+def under_memory_pressure():
+    if DEVICE == "cuda":
+        free_memory, total_memory = torch.cuda.mem_get_info()
+        return free_memory < total_memory * sr_pressure_ratio
+    try:
+        return os.sysconf("SC_AVPHYS_PAGES") * os.sysconf("SC_PAGE_SIZE") // (1024 * 1024) < sr_pressure_memory
+    except (ValueError, OSError, AttributeError):
+        return False
+
+def release_sr_models(reason):
+    with sr_lock:
+        loaded = [scale for scale, sr_m in sr_model.items() if sr_m is not None]
+        if not loaded:
+            return
+        for scale in loaded:
+            sr_model[scale] = None
+    gc.collect()
+    torch.cuda.empty_cache()
+    print("Released Super Resolution Models", loaded, "-", reason)
+
+def load_sr_model(scale):
+    global sr_last_used
+    with sr_lock:
+        sr_last_used = time.monotonic()
+        if sr_model[scale] is not None:
+            return sr_model[scale]
+    if under_memory_pressure():
+        release_sr_models("Memory Pressure")
+    with sr_lock:
+        if sr_model[scale] is None:
+            load_start = time.monotonic()
+            sr_model[scale] = get_sr_model(scale)
+            print("Loaded Super Resolution Model x" + str(scale), "in",
+                  round(time.monotonic() - load_start, 2), "Seconds")
+        return sr_model[scale]
+
+def release_idle_sr_models():
+    if sr_last_used and time.monotonic() - sr_last_used > sr_idle_timeout:
+        release_sr_models("Idle for " + str(sr_idle_timeout) + " Seconds")
 
 print("Depth Model is Fully Loaded.")
 
@@ -249,8 +365,16 @@ def sr_upscale(image, scale):
     image_t = image_t_c.to(DEVICE).unsqueeze(0)
 
     if (scale == 2 or scale == 3 or scale == 4):
-        with torch.no_grad():
-            image_sr_t = sr_model[scale](image_t)
+        try:
+            with torch.no_grad():
+                image_sr_t = load_sr_model(scale)(image_t)
+        except RuntimeError as error:
+            if "out of memory" not in str(error).lower():
+                raise
+            del image_t, image_t_c
+            release_sr_models("Out of Memory")
+            print("Skipping Super Resolution x" + str(scale))
+            return image
     else:
         return image
 
@@ -298,7 +422,40 @@ def file_is_cubevi(file_name):
             return True
     return False
 
-def generate_depth(in_file):
+def attach_shared_buffer(name):
+    try:
+        return shared_memory.SharedMemory(name=name, track=False)
+    except TypeError:
+        buffer = shared_memory.SharedMemory(name=name)
+        if os.name != "nt":
+            resource_tracker.unregister(buffer._name, "shared_memory")
+        return buffer
+
+def read_shared_color(shared):
+    name, width, height = shared
+    try:
+        buffer = attach_shared_buffer(name)
+    except (FileNotFoundError, OSError, ValueError):
+        print("Error Attaching Shared Buffer: " + name)
+        return None, None
+    pixels = numpy.ndarray((height, width, 4), dtype=numpy.uint8, buffer=buffer.buf)
+    image_color = pixels[:, :, 2::-1].copy()
+    del pixels
+    return buffer, image_color
+
+def stage_time(timings, stage, stage_start):
+    stage_end = time.perf_counter()
+    timings[stage] = round((stage_end - stage_start) * 1000.0, 2)
+    return stage_end
+
+def get_output_file(in_file, file_tag="rgbd"):
+    file_wo_ext = os.path.splitext(os.path.basename(in_file))[0]
+    export_file = file_wo_ext + "_" + file_tag + ".jpg"
+    if file_is_cubevi(file_wo_ext):
+        export_file = file_wo_ext + ".mp4"
+    return os.path.normpath(os.path.join(export_dir, export_file))
+
+def load_depth_input(in_file, shared=None, file_tag="rgbd"):
     if not in_file:
         print("Exiting. No File to Load.")
         return "ERROR"
@@ -312,13 +469,8 @@ def generate_depth(in_file):
         print("Exiting. Not a Supported Image: " + in_file)
         return "ERROR"
 
-    file_only = os.path.basename(in_file)
-    file_wo_ext = os.path.splitext(file_only)[0]
-    file_tag = "rgbd"
-    file_ext = ".jpg"
-    file_sep = "_"
-    export_file = file_wo_ext + file_sep + file_tag + file_ext
-    out_file = os.path.normpath(os.path.join(export_dir, export_file))
+    file_wo_ext = os.path.splitext(os.path.basename(in_file))[0]
+    out_file = get_output_file(in_file, file_tag)
 
     if file_is_tagged(file_wo_ext):
         if app_mode == 0:
@@ -328,22 +480,24 @@ def generate_depth(in_file):
     print("Attempting to Load:", in_file)
 
     if file_is_cubevi(file_wo_ext):
-        export_file = file_wo_ext + ".mp4"
-        out_file = os.path.normpath(os.path.join(export_dir, export_file))
-        print("Try to save MP4:", out_file)
-        image_clip = ImageClip(in_file).with_duration(1)
-        image_clip.write_videofile(out_file, codec="libx264", fps=24, preset="ultrafast")
-        image_clip.close()
-        del image_clip
-        return out_file
-
-    try:
-        image_color = Image.open(in_file).convert("RGB")
-        image_color = numpy.array(image_color)[:, :, ::-1].copy()
-    except:
-        print("Error Loading Image File: " + in_file)
-        return "ERROR"
+        return { "video": in_file, "out_file": out_file }
+
+    timings = {}
+    stage_start = time.perf_counter()
+    shared_buffer = None
+    if shared:
+        shared_buffer, image_color = read_shared_color(shared)
+        if shared_buffer is None:
+            return "ERROR"
+    else:
+        try:
+            image_color = Image.open(in_file).convert("RGB")
+            image_color = numpy.array(image_color)[:, :, ::-1].copy()
+        except:
+            print("Error Loading Image File: " + in_file)
+            return "ERROR"
 
+    stage_start = stage_time(timings, "decode", stage_start)
     image_height, image_width = image_color.shape[:2]
     image_aspect = image_width / image_height
 
@@ -365,26 +519,243 @@ def generate_depth(in_file):
     sr_scale_factor = int(scale_factor)
     sr_scale_factor = min(int(sr_scale_factor), 4)
 
-    if (sr_scale_factor > 1):
+    if (sr_scale_factor > 1 and not shared_buffer):
         image_color = sr_upscale(image_color, sr_scale_factor)
+        stage_start = stage_time(timings, "upscale", stage_start)
+
+    job = { "color": image_color, "out_file": out_file, "process_size": process_size, "timings": timings,
+            "size": (int(process_size * width_restore), int(process_size * height_restore)) }
+
+    layout = get_tile_layout(image_color.shape[1], image_color.shape[0])
+    if layout:
+        tile_size = layout["tile"]
+        job["input"] = cv2.resize(image_color, (tile_size, tile_size), interpolation=cv2.INTER_AREA)
+        job["layout"] = layout
+        print("Tiled Inference with", len(layout["offsets"]), "Tiles of", layout["source_tile"], "on",
+              image_color.shape[1], "x", image_color.shape[0])
+    else:
+        job["input"] = cv2.resize(image_color, (process_size, process_size), fx=None, fy=None,
+                                  interpolation=cv2.INTER_LANCZOS4)
+    stage_time(timings, "prepare", stage_start)
+    if shared_buffer:
+        job["shared"] = (shared_buffer, shared[1], shared[2])
+        if not layout:
+            del job["color"]
+    return job
+
+def prepare_depth(in_file, shared=None, refine=False):
+    job = load_depth_input(in_file, shared, "refined_rgbd" if refine else "rgbd")
+    if isinstance(job, str) or "video" in job:
+        return job
+
+    depth_net = get_refine_model() if refine else model
+    stage_start = time.perf_counter()
+    if "layout" in job:
+        infer_tiled(job, depth_net, refine_encoder if refine else encoder)
+    else:
+        with torch.no_grad():
+            job["depth"] = depth_net.infer_image(job.pop("input"), depth_size)
+    stage_time(job["timings"], "infer", stage_start)
+    job["refine"] = refine
+    return job
+
+batch_image_cost = { "vits": 160, "vitb": 320, "vitl": 900 }
+
+def get_memory_budget():
+    if memory_budget > 0:
+        return memory_budget
+    if DEVICE == "cuda":
+        free_memory, total_memory = torch.cuda.mem_get_info()
+        return free_memory // (1024 * 1024) // 2
+    try:
+        return os.sysconf("SC_AVPHYS_PAGES") * os.sysconf("SC_PAGE_SIZE") // (1024 * 1024) // 4
+    except (ValueError, OSError, AttributeError):
+        return 2048
+
+def get_batch_limit(name=None):
+    image_cost = batch_image_cost[name or encoder] * (depth_size / 518.0) ** 2
+    return max(1, min(max_batch, int(get_memory_budget() / image_cost)))
+
+def infer_batch(jobs, depth_net=None):
+    depth_net = depth_net or model
+    tensors = []
+    for job in jobs:
+        tensor, (input_height, input_width) = depth_net.image2tensor(job["input"], depth_size)
+        tensors.append(tensor)
+    try:
+        with torch.no_grad():
+            depth = depth_net.forward(torch.cat(tensors).to(DEVICE))
+            depth = F.interpolate(depth[:, None], (input_height, input_width), mode="bilinear",
+                                  align_corners=True)[:, 0]
+        depth = depth.cpu().numpy()
+    except RuntimeError as error:
+        if len(jobs) == 1 or "out of memory" not in str(error).lower():
+            raise
+        del tensors
+        release_sr_models("Out of Memory")
+        torch.cuda.empty_cache()
+        half = len(jobs) // 2
+        print("Batch Out of Memory. Retrying with Batch Size", half)
+        return infer_batch(jobs[:half], depth_net) + infer_batch(jobs[half:], depth_net)
+
+    for i, job in enumerate(jobs):
+        del job["input"]
+        job["depth"] = depth[i]
+    return jobs
+
+tile_scale = 2
+tile_ratio = 2.0
+tile_overlap = 0.25
+tile_floor = 0.05
+tile_limit = 16
+tile_growth = 1.25
+
+def get_tile_offsets(length, tile_size, overlap):
+    count = max(1, -(-(length - overlap) // (tile_size - overlap)))
+    if count == 1:
+        return [0]
+    return [round(i * (length - tile_size) / (count - 1)) for i in range(count)]
+
+def get_tile_layout(width, height):
+    if tile_mode == 0:
+        return None
+    tile_size = depth_size * tile_scale
+    source_tile = min(width, height, tile_size)
+    if tile_mode == 1 and max(width, height) < source_tile * tile_ratio:
+        return None
+    while True:
+        overlap = int(source_tile * tile_overlap)
+        offsets = [(x, y) for y in get_tile_offsets(height, source_tile, overlap)
+                   for x in get_tile_offsets(width, source_tile, overlap)]
+        if len(offsets) <= tile_limit or source_tile >= min(width, height):
+            break
+        source_tile = min(int(source_tile * tile_growth), width, height)
+    if len(offsets) < 2:
+        return None
+    canvas_scale = min(1.0, depth_size / source_tile)
+    canvas = (max(1, round(width * canvas_scale)), max(1, round(height * canvas_scale)))
+    return { "canvas": canvas, "scale": canvas_scale, "tile": tile_size, "source_tile": source_tile,
+             "overlap": overlap, "offsets": offsets }
+
+def get_tile_ramp(length, overlap):
+    ramp = numpy.ones(length, dtype=numpy.float32)
+    overlap = min(overlap, length // 2)
+    if overlap > 0:
+        edge = numpy.clip((numpy.arange(overlap, dtype=numpy.float32) + 0.5) / overlap, tile_floor, 1.0)
+        ramp[:overlap] = edge
+        ramp[-overlap:] = numpy.minimum(ramp[-overlap:], edge[::-1])
+    return ramp
+
+def get_tile_weights(width, height, overlap):
+    return numpy.outer(get_tile_ramp(height, overlap), get_tile_ramp(width, overlap))
+
+def cut_tile(image, offset, layout):
+    x, y = offset
+    source_tile = layout["source_tile"]
+    tile_size = layout["tile"]
+    tile = image[y:y + source_tile, x:x + source_tile]
+    interpolation = cv2.INTER_AREA if source_tile > tile_size else cv2.INTER_LINEAR
+    return cv2.resize(tile, (tile_size, tile_size), interpolation=interpolation)
+
+def align_tile(depth, reference):
+    depth_offset = depth - depth.mean()
+    variance = float((depth_offset * depth_offset).mean())
+    scale = 0.0
+    if variance > 1e-8:
+        scale = max(0.0, float((depth_offset * (reference - reference.mean())).mean()) / variance)
+    return depth_offset * scale + reference.mean()
+
+def infer_tiled(job, depth_net=None, name=None):
+    layout = job.pop("layout")
+    image_color = job.pop("color") if "shared" in job else job["color"]
+    scale = layout["scale"]
+    source_tile = layout["source_tile"]
+    canvas_width, canvas_height = layout["canvas"]
+    overlap = int(layout["overlap"] * scale)
+    merged = numpy.zeros((canvas_height, canvas_width), dtype=numpy.float32)
+    total = numpy.zeros((canvas_height, canvas_width), dtype=numpy.float32)
+    reference = None
+    tile_jobs = [{ "input": job.pop("input") }] + [{ "offset": offset } for offset in layout["offsets"]]
+    batch_limit = get_batch_limit(name)
+    for start in range(0, len(tile_jobs), batch_limit):
+        batch = tile_jobs[start:start + batch_limit]
+        for tile_job in batch:
+            if "offset" in tile_job:
+                tile_job["input"] = cut_tile(image_color, tile_job["offset"], layout)
+        infer_batch(batch, depth_net)
+        for tile_job in batch:
+            depth = tile_job.pop("depth").astype(numpy.float32)
+            if "offset" not in tile_job:
+                reference = cv2.resize(depth, (canvas_width, canvas_height), interpolation=cv2.INTER_LINEAR)
+                continue
+            x, y = tile_job["offset"]
+            left, top = round(x * scale), round(y * scale)
+            right = min(round((x + source_tile) * scale), canvas_width)
+            bottom = min(round((y + source_tile) * scale), canvas_height)
+            depth = cv2.resize(depth, (right - left, bottom - top), interpolation=cv2.INTER_AREA)
+            region = (slice(top, bottom), slice(left, right))
+            weights = get_tile_weights(right - left, bottom - top, overlap)
+            merged[region] += align_tile(depth, reference[region]) * weights
+            total[region] += weights
+    job["depth"] = merged / numpy.maximum(total, 1e-6)
+    return job
+
+def write_video(job):
+    in_file = job["video"]
+    out_file = job["out_file"]
+    print("Try to save MP4:", out_file)
+    image_clip = ImageClip(in_file).with_duration(1)
+    image_clip.write_videofile(out_file, codec="libx264", fps=24, preset="ultrafast")
+    image_clip.close()
+    del image_clip
+    return out_file
 
-    image_resize = cv2.resize(image_color, (process_size, process_size), fx=None, fy=None,
-                              interpolation=cv2.INTER_LANCZOS4)
-    image_height, image_width = image_resize.shape[:2]
+def get_plane_size(width, height):
+    scale = min(1.0, depth_size / min(width, height))
+    return max(1, int(round(width * scale))), max(1, int(round(height * scale)))
+
+def write_shared_depth(job):
+    shared_buffer, width, height = job["shared"]
+    timings = job.get("timings", {})
+    stage_start = time.perf_counter()
+    depth = job["depth"]
+    depth = (depth - depth.min()) / (depth.max() - depth.min()) * 255.0
+    plane_width, plane_height = get_plane_size(width, height)
+    depth = cv2.resize(depth, (plane_width, plane_height), interpolation = cv2.INTER_AREA)
+    stage_start = stage_time(timings, "resize", stage_start)
+    plane = numpy.ndarray((plane_height, plane_width), dtype=numpy.uint8, buffer=shared_buffer.buf,
+                          offset=width * height * 4)
+    plane[:] = numpy.clip(depth, 0.0, 255.0).astype(numpy.uint8)
+    del plane
+    shared_buffer.close()
+    stage_time(timings, "encode", stage_start)
+    print("Generated Depth Successfully for Shared Buffer", plane_width, "x", plane_height)
+    return ("depth", str(plane_width) + "x" + str(plane_height))
+
+def write_depth(job):
+    if "video" in job:
+        return write_video(job)
+    if "shared" in job:
+        return write_shared_depth(job)
+
+    image_color = job["color"]
+    depth = job["depth"]
+    out_file = job["out_file"]
+    output_size = job["size"]
+    timings = job.get("timings", {})
+    stage_start = time.perf_counter()
 
-    with torch.no_grad():
-        depth = model.infer_image(image_resize, depth_size)
     depth = (depth - depth.min()) / (depth.max() - depth.min()) * 255.0
     depth = depth.astype(numpy.uint8)
     depth = numpy.repeat(depth[..., numpy.newaxis], 3, axis=-1)
 
-    image_resize = cv2.resize(image_color, (int(image_width * width_restore),
-                                            int(image_height * height_restore)), interpolation = cv2.INTER_LANCZOS4)
-    depth_resize = cv2.resize(depth, (int(image_width * width_restore),
-                                      int(image_height * height_restore)), interpolation = cv2.INTER_LANCZOS4)
+    image_resize = cv2.resize(image_color, output_size, interpolation = cv2.INTER_LANCZOS4)
+    depth_resize = cv2.resize(depth, output_size, interpolation = cv2.INTER_LANCZOS4)
+    stage_start = stage_time(timings, "resize", stage_start)
 
     image_output = cv2.hconcat([image_resize, depth_resize])
     success = cv2.imwrite(out_file, image_output, [cv2.IMWRITE_JPEG_QUALITY, 90])
+    stage_time(timings, "encode", stage_start)
 
     if success:
         print("Generated Depth Successfully for " + out_file)
@@ -398,6 +769,71 @@ def generate_depth(in_file):
 
     return out_file
 
+def generate_depth(in_file):
+    job = prepare_depth(in_file)
+    if isinstance(job, str):
+        return job
+    return write_depth(job)
+
+load_workers = max(2, min(4, (os.cpu_count() or 2) // 2))
+write_workers = max(2, (os.cpu_count() or 2) // 2)
+
+manifest_name = "Manifest.json"
+manifest_version = 1
+manifest_interval = 1.0
+
+def get_file_hash(path):
+    digest = hashlib.blake2b(digest_size=16)
+    with open(path, "rb") as file:
+        for chunk in iter(lambda: file.read(1 << 20), b""):
+            digest.update(chunk)
+    return digest.hexdigest()
+
+def get_source_info(in_file, entry):
+    stat = os.stat(in_file)
+    if entry and entry.get("size") == stat.st_size and entry.get("mtime") == stat.st_mtime_ns:
+        source_hash = entry.get("hash")
+    else:
+        source_hash = get_file_hash(in_file)
+    return { "hash": source_hash, "size": stat.st_size, "mtime": stat.st_mtime_ns }
+
+def get_batch_settings():
+    return get_service_settings() + " " + str(tile_mode)
+
+def load_manifest(manifest_file):
+    try:
+        with open(manifest_file) as file:
+            manifest = json.load(file)
+        if manifest.get("version") == manifest_version and isinstance(manifest.get("files"), dict):
+            return manifest
+    except (OSError, ValueError, AttributeError):
+        pass
+    return { "version": manifest_version, "files": {} }
+
+def save_manifest(manifest_file, manifest):
+    manifest_temp = manifest_file + "." + str(os.getpid())
+    try:
+        with open(manifest_temp, "w") as file:
+            json.dump(manifest, file, indent=1)
+        os.replace(manifest_temp, manifest_file)
+    except OSError:
+        print("Error Saving Manifest:", manifest_file)
+
+def run_batch(batch, writer, writes):
+    for job in infer_batch(batch):
+        writes.append((job["source"], writer.submit(write_depth, job)))
+    batch.clear()
+
+def wait_for_writes(writes, limit, finish):
+    while len(writes) > limit:
+        name, write = writes.popleft()
+        try:
+            result = write.result()
+        except Exception as error:
+            print("Error Writing Depth:", error)
+            result = "ERROR"
+        finish(name, result)
+
 def batch_convert(in_dir):
     if not in_dir:
         print("Exiting. No Directory to Load.")
@@ -407,36 +843,271 @@ def batch_convert(in_dir):
         print("Exiting. Error Loading Directory " + in_dir)
         return "ERROR"
 
-    input_names = os.listdir(in_dir)
-    for file in input_names:
+    manifest_file = os.path.join(export_dir, manifest_name)
+    manifest = load_manifest(manifest_file)
+    settings = get_batch_settings()
+    entries = manifest["files"]
+    input_files = []
+    skipped = 0
+    for file in sorted(os.listdir(in_dir)):
+        in_file = os.path.normpath(os.path.join(in_dir, file))
+        if not os.path.isfile(in_file) or not file_type_supported(file):
+            continue
         file_wo_ext = os.path.splitext(file)[0]
         if file_is_tagged(file_wo_ext):
             print("Skipping Conversion. File Already 3D Tagged: " + file)
             continue
-        generate_depth(os.path.normpath(os.path.join(in_dir, file)))
-
-    print("Generated Depth for Directory Successfully.")
+        entry = entries.get(file)
+        try:
+            source = get_source_info(in_file, entry)
+        except OSError:
+            print("Skipping Conversion. Error Reading File: " + file)
+            continue
+        out_file = get_output_file(in_file)
+        finished = entry is None or (entry.get("status") == "done" and entry.get("hash") == source["hash"] and
+                                     entry.get("settings") == settings)
+        entries[file] = dict(source, settings=settings, output=os.path.basename(out_file), status="pending")
+        if finished and os.path.isfile(out_file):
+            entries[file]["status"] = "done"
+            skipped += 1
+            continue
+        input_files.append(in_file)
+
+    progress = { "total": len(input_files) + skipped, "done": skipped, "failed": 0, "skipped": skipped,
+                 "running": True }
+    manifest["progress"] = progress
+    save_manifest(manifest_file, manifest)
+    last_save = time.monotonic()
+
+    def finish(name, result):
+        nonlocal last_save
+        failed = result == "ERROR"
+        entries[name]["status"] = "error" if failed else "done"
+        progress["done" if not failed else "failed"] += 1
+        if time.monotonic() - last_save >= manifest_interval:
+            save_manifest(manifest_file, manifest)
+            last_save = time.monotonic()
+
+    batch_limit = get_batch_limit()
+    print("Converting", len(input_files), "Files with Batch Size", batch_limit, "- Already Done:", skipped)
+
+    next_files = iter(input_files)
+    loads = deque()
+    writes = deque()
+    batches = {}
+    with ThreadPoolExecutor(max_workers=load_workers) as loader, \
+            ThreadPoolExecutor(max_workers=write_workers) as writer:
+        def queue_loads():
+            while len(loads) < batch_limit * 2:
+                next_file = next(next_files, None)
+                if next_file is None:
+                    return
+                loads.append((os.path.basename(next_file), loader.submit(load_depth_input, next_file)))
+
+        queue_loads()
+        while loads:
+            name, load = loads.popleft()
+            job = load.result()
+            queue_loads()
+            if isinstance(job, str):
+                finish(name, job)
+                continue
+            job["source"] = name
+            if "video" in job:
+                writes.append((name, writer.submit(write_depth, job)))
+                continue
+            if "layout" in job:
+                writes.append((name, writer.submit(write_depth, infer_tiled(job))))
+                wait_for_writes(writes, write_workers * 2, finish)
+                continue
+            batch = batches.setdefault(job["process_size"], [])
+            batch.append(job)
+            if len(batch) >= batch_limit:
+                run_batch(batch, writer, writes)
+                wait_for_writes(writes, write_workers * 2, finish)
+
+        for batch in batches.values():
+            if batch:
+                run_batch(batch, writer, writes)
+        wait_for_writes(writes, 0, finish)
+
+    progress["running"] = False
+    save_manifest(manifest_file, manifest)
+    print("Generated Depth for Directory Successfully.", progress["done"] - skipped, "Converted,",
+          progress["failed"], "Failed.")
+
+poll_timeout = 5
+quit_linger = 200
+write_queue_size = 2
+refine_priority = 2
+client_timeout = 15.0
+cancelled = set()
+clients = {}
+
+def infer_worker(jobs, writes, results, telemetry):
+    while True:
+        priority, sequence, peer, job_id, in_file, shared, refine = jobs.get()
+        if peer is None:
+            writes.put(None)
+            return
+        if refine and (peer, job_id) in cancelled:
+            cancelled.discard((peer, job_id))
+            results.put((peer, job_id, None, False))
+            continue
+        job = prepare_depth(in_file, shared, refine)
+        if isinstance(job, str):
+            results.put((peer, job_id, job, False))
+            continue
+        draft = progressive and not refine and "video" not in job
+        telemetry.put((peer, job_id, "infer", dict(job.get("timings", {})), refine))
+        writes.put((peer, job_id, job, draft))
+        if draft:
+            jobs.put((priority + refine_priority, sequence, peer, job_id, in_file, shared, True))
+
+def write_worker(writes, results, telemetry):
+    while True:
+        item = writes.get()
+        if item is None:
+            return
+        peer, job_id, job, draft = item
+        result = write_depth(job)
+        telemetry.put((peer, job_id, "done", job.get("timings", {}), job.get("refine", False)))
+        results.put((peer, job_id, result, draft))
+
+def send_results(results):
+    sent = 0
+    while True:
+        try:
+            peer, job_id, result, draft = results.get_nowait()
+        except queue.Empty:
+            return sent
+        if draft and result == "ERROR":
+            continue
+        if not draft:
+            sent += 1
+            cancelled.discard((peer, job_id))
+        if result is None:
+            continue
+        if isinstance(result, tuple):
+            reply, result = result
+        else:
+            reply = "error" if result == "ERROR" else "done"
+        frames = [peer, reply.encode(), job_id, result.encode()]
+        if draft:
+            frames.append(b"refine")
+        signal_control.send_multipart(frames)
+
+def publish_telemetry(telemetry, queue_depth):
+    while True:
+        try:
+            peer, job_id, stage, timings, refine = telemetry.get_nowait()
+        except queue.Empty:
+            return
+        message = { "id": int(job_id), "stage": stage, "timings": timings, "queue": queue_depth,
+                    "device": device_label, "model": label, "refine": refine }
+        signal_telemetry.send_multipart([peer, json.dumps(message).encode()])
+
+def publish_service():
+    service_info = { "endpoint": send_io, "pid": os.getpid(), "settings": get_service_settings() }
+    service_temp = service_file + "." + str(os.getpid())
+    with open(service_temp, "w") as file:
+        json.dump(service_info, file)
+    os.replace(service_temp, service_file)
+    print("DepthGenerate Service Listening on", send_io)
+
+def withdraw_service():
+    try:
+        with open(service_file) as file:
+            if json.load(file).get("pid") != os.getpid():
+                return
+        os.remove(service_file)
+    except (OSError, ValueError):
+        pass
+
+def quit_service(jobs, peer=None):
+    print("Quiting DepthGenerate")
+    jobs.put((-1, -1, None, None, None, None, False))
+    if peer is not None:
+        signal_control.send_multipart([peer, b"bye"])
+    if app_mode == 4:
+        withdraw_service()
+    else:
+        signal_control.disconnect(send_io)
+    signal_context.destroy(linger=quit_linger)
+    sys.exit()
 
 def wait_for_command():
-    result = ""
-    while (result != "quit"):
-        message = signal_control.recv_string()
-
-        if (message == "quit"):
-            print("Quiting DepthGenerate")
-            signal_control.disconnect(send_io)
-            signal_context.destroy()
-            sys.exit()
-
-        result = generate_depth(message)
-        signal_control.send_string(result)
+    jobs = queue.PriorityQueue()
+    writes = queue.Queue(maxsize=write_queue_size)
+    results = queue.Queue()
+    telemetry = queue.Queue()
+    threading.Thread(target=infer_worker, args=(jobs, writes, results, telemetry), daemon=True).start()
+    threading.Thread(target=write_worker, args=(writes, results, telemetry), daemon=True).start()
+
+    poller = zmq.Poller()
+    poller.register(signal_control, zmq.POLLIN)
+    if app_mode == 4:
+        publish_service()
+    sequence = 0
+    outstanding = 0
+    last_activity = time.monotonic()
+    while True:
+        events = dict(poller.poll(poll_timeout))
+        while signal_control in events:
+            try:
+                frames = signal_control.recv_multipart(zmq.NOBLOCK)
+            except zmq.Again:
+                break
+            message = frames[1].decode() if len(frames) > 1 else ""
+            last_activity = time.monotonic()
+            clients[frames[0]] = last_activity
+
+            if message == "quit":
+                clients.pop(frames[0], None)
+                active = [peer for peer, seen in clients.items() if last_activity - seen < client_timeout]
+                if app_mode == 4 and active:
+                    print("Keeping DepthGenerate Service for", len(active), "Other Clients")
+                    signal_control.send_multipart([frames[0], b"bye"])
+                    continue
+                quit_service(jobs, frames[0])
+
+            if message == "hello":
+                signal_control.send_multipart([frames[0], b"ready", label.encode(), device_label.encode(),
+                                               get_service_settings().encode(), telemetry_io.encode()])
+
+            if message == "ping":
+                signal_control.send_multipart([frames[0], b"pong"])
+
+            if message == "cancel" and len(frames) >= 3:
+                cancelled.add((frames[0], frames[2]))
+
+            if message == "job" and len(frames) >= 5:
+                sequence += 1
+                outstanding += 1
+                shared = None
+                if len(frames) >= 6 and frames[5]:
+                    name, width, height = frames[5].decode().split(" ")
+                    shared = (name, int(width), int(height))
+                jobs.put((int(frames[3]), sequence, frames[0], frames[2], frames[4].decode(), shared, False))
+                telemetry.put((frames[0], frames[2], "queued", {}, False))
+
+        publish_telemetry(telemetry, jobs.qsize() + writes.qsize())
+        sent = send_results(results)
+        if sent:
+            outstanding -= sent
+            last_activity = time.monotonic()
+        if outstanding <= 0:
+            release_idle_sr_models()
+        if app_mode == 4 and outstanding <= 0 and time.monotonic() - last_activity > idle_timeout:
+            print("DepthGenerate Idle for", idle_timeout, "Seconds")
+            quit_service(jobs)
 
 def main():
     if app_mode == 0:
         generate_depth(input_name)
     elif app_mode == 1:
         batch_convert(input_name)
-    elif app_mode == 2:
+    elif app_mode == 2 or app_mode == 4:
         wait_for_command()
 
 if __name__ == "__main__":
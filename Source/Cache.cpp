@@ -0,0 +1,187 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Cache.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+Uint64 Cache::hashFile(const std::string& path) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) return 0;
+	std::array<Uint64, 4> lanes = { 0xCBF29CE484222325ull, 0x84222325CBF29CE4ull,
+		0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full };
+	auto mix = [](Uint64 lane, Uint64 value) {
+		lane = (lane ^ value) * 0x100000001B3ull;
+		return lane ^ (lane >> 29);
+	};
+	Uint64 fileSize = 0;
+	std::vector<char> chunk(chunkSize);
+	while (file) {
+		file.read(chunk.data(), (std::streamsize)chunkSize);
+		auto count = (size_t)file.gcount();
+		if (count == 0) break;
+		fileSize += count;
+		std::memset(chunk.data() + count, 0, (32 - count % 32) % 32);
+		for (size_t i = 0; i < count; i += 32) {
+			for (auto lane = 0; lane < 4; ++lane) {
+				Uint64 value;
+				std::memcpy(&value, chunk.data() + i + lane * 8, sizeof(value));
+				lanes[lane] = mix(lanes[lane], value);
+			}
+		}
+	}
+	if (file.bad()) return 0;
+	auto hash = mix(0xCBF29CE484222325ull, fileSize);
+	for (auto lane : lanes) hash = mix(hash, lane);
+	return hash == 0 ? 1 : hash;
+}
+
+std::filesystem::path Cache::getPath(const std::string& key) {
+	return cacheFolder / (key + ".depth");
+}
+
+std::string Cache::getKey(const std::string& path, const std::string& model,
+	const std::string& depthSize, const std::string& upscale) {
+	if (!useCache || cacheFolder.empty()) return "";
+	auto hash = hashFile(path);
+	if (hash == 0) return "";
+	char hashText[17];
+	std::snprintf(hashText, sizeof(hashText), "%016llx", (unsigned long long)hash);
+	return std::string(hashText) + "_" + model + "_" + depthSize + "_" + upscale;
+}
+
+bool Cache::load(const std::string& key, std::vector<Uint8>& depth, glm::ivec2& depthSize) {
+	if (key.empty()) return false;
+	auto cachePath = getPath(key);
+	std::ifstream file(cachePath, std::ios::binary);
+	if (!file) return false;
+
+	std::array<Uint32, 3> header{};
+	file.read(reinterpret_cast<char*>(header.data()), sizeof(header));
+	if (!file || header[0] != cacheMagic || header[1] == 0 || header[2] == 0 ||
+		header[1] > (Uint32)maxPlaneSize || header[2] > (Uint32)maxPlaneSize) return false;
+	std::vector<Uint8> plane((size_t)header[1] * header[2]);
+	file.read(reinterpret_cast<char*>(plane.data()), (std::streamsize)plane.size());
+	if (!file) return false;
+	file.close();
+
+	std::error_code error;
+	std::filesystem::last_write_time(cachePath, std::filesystem::file_time_type::clock::now(), error);
+	depth = std::move(plane);
+	depthSize = { (int)header[1], (int)header[2] };
+	return true;
+}
+
+int Cache::store(const std::string& key, const std::vector<Uint8>& depth, glm::ivec2 depthSize) {
+	if (key.empty() || depthSize.x <= 0 || depthSize.y <= 0 ||
+		depth.size() < (size_t)depthSize.x * depthSize.y) return -1;
+	std::error_code error;
+	std::filesystem::create_directories(cacheFolder, error);
+	if (error) return -1;
+
+	auto scale = std::max(1, (std::max(depthSize.x, depthSize.y) + maxPlaneSize - 1) / maxPlaneSize);
+	glm::ivec2 planeSize = { depthSize.x / scale, depthSize.y / scale };
+	std::vector<Uint8> plane;
+	const std::vector<Uint8>* output = &depth;
+	if (scale > 1) {
+		plane.resize((size_t)planeSize.x * planeSize.y);
+		for (auto y = 0; y < planeSize.y; ++y) {
+			for (auto x = 0; x < planeSize.x; ++x) {
+				auto sum = 0u;
+				for (auto sy = 0; sy < scale; ++sy) {
+					auto row = depth.data() + (size_t)(y * scale + sy) * depthSize.x + (size_t)x * scale;
+					for (auto sx = 0; sx < scale; ++sx) sum += row[sx];
+				}
+				plane[(size_t)y * planeSize.x + x] = (Uint8)(sum / (scale * scale));
+			}
+		}
+		output = &plane;
+	}
+
+	auto cachePath = getPath(key);
+	auto tempPath = cachePath;
+	tempPath += ".tmp";
+	std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+	if (!file) return -1;
+	std::array<Uint32, 3> header = { cacheMagic, (Uint32)planeSize.x, (Uint32)planeSize.y };
+	file.write(reinterpret_cast<const char*>(header.data()), sizeof(header));
+	file.write(reinterpret_cast<const char*>(output->data()), (std::streamsize)((size_t)planeSize.x * planeSize.y));
+	file.close();
+	if (!file) {
+		std::filesystem::remove(tempPath, error);
+		return -1;
+	}
+	std::filesystem::rename(tempPath, cachePath, error);
+	if (error) {
+		std::filesystem::remove(tempPath, error);
+		return -1;
+	}
+	trim();
+	return 0;
+}
+
+int Cache::storeSurface(const std::string& key, const SDL_Surface* colorDepth) {
+	if (key.empty() || colorDepth == nullptr || colorDepth->w < 2) return -1;
+	SDL_Surface* converted = nullptr;
+	if (colorDepth->format != SDL_PIXELFORMAT_ABGR8888) {
+		converted = SDL_ConvertSurface(const_cast<SDL_Surface*>(colorDepth), SDL_PIXELFORMAT_ABGR8888);
+		if (converted == nullptr) return -1;
+		colorDepth = converted;
+	}
+	glm::ivec2 depthSize = { colorDepth->w / 2, colorDepth->h };
+	std::vector<Uint8> depth((size_t)depthSize.x * depthSize.y);
+	for (auto y = 0; y < depthSize.y; ++y) {
+		auto source = static_cast<const Uint8*>(colorDepth->pixels) + (size_t)y * colorDepth->pitch +
+			(size_t)(colorDepth->w - depthSize.x) * 4;
+		auto target = depth.data() + (size_t)y * depthSize.x;
+		for (auto x = 0; x < depthSize.x; ++x) target[x] = source[(size_t)x * 4];
+	}
+	SDL_DestroySurface(converted);
+	return store(key, depth, depthSize);
+}
+
+void Cache::trim() {
+	struct Entry {
+		std::filesystem::path path;
+		std::filesystem::file_time_type time;
+		Uint64 size;
+	};
+	std::error_code error;
+	if (!std::filesystem::exists(cacheFolder, error)) return;
+	std::vector<Entry> entries;
+	Uint64 totalSize = 0;
+	for (const auto& entry : std::filesystem::directory_iterator(cacheFolder, error)) {
+		if (entry.path().extension() != ".depth") continue;
+		auto size = (Uint64)entry.file_size(error);
+		if (error) continue;
+		entries.push_back({ entry.path(), entry.last_write_time(error), size });
+		totalSize += size;
+	}
+	if (totalSize <= maxCacheSize) return;
+	std::sort(entries.begin(), entries.end(),
+		[](const Entry& a, const Entry& b) { return a.time < b.time; });
+	for (const auto& entry : entries) {
+		if (totalSize <= maxCacheSize) break;
+		if (std::filesystem::remove(entry.path, error)) totalSize -= entry.size;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RENDEPTH_CACHE_H
+#define RENDEPTH_CACHE_H
+
+#include <SDL3/SDL.h>
+#include "glm/glm.hpp"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+class Cache {
+public:
+	static std::string getKey(const std::string& path, const std::string& model,
+		const std::string& depthSize, const std::string& upscale);
+	static bool load(const std::string& key, std::vector<Uint8>& depth, glm::ivec2& depthSize);
+	static int store(const std::string& key, const std::vector<Uint8>& depth, glm::ivec2 depthSize);
+	static int storeSurface(const std::string& key, const SDL_Surface* colorDepth);
+	static void trim();
+	inline static std::filesystem::path cacheFolder;
+	inline static Uint64 maxCacheSize = 1024ull * 1024 * 1024;
+	inline static int maxPlaneSize = 2048;
+	inline static bool useCache = true;
+private:
+	static Uint64 hashFile(const std::string& path);
+	static std::filesystem::path getPath(const std::string& key);
+	inline static const Uint32 cacheMagic = 0x43504452;
+	inline static const size_t chunkSize = 1024 * 1024;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,172 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Clip.h"
+#include "Png.h"
+#include "Render.h"
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include <thread>
+#ifdef WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+void Clip::convertFrame(const SDL_Surface* frame, std::vector<Uint8>& data) {
+	if (format == Clip_Png) {
+		Png::encode(frame, data);
+		return;
+	}
+	auto frameWidth = frame->w, frameHeight = frame->h;
+	auto lumaSize = (size_t)frameWidth * frameHeight;
+	auto chromaWidth = frameWidth / 2;
+	auto chromaSize = (size_t)chromaWidth * (frameHeight / 2);
+	const char header[] = "FRAME\n";
+	data.resize(sizeof(header) - 1 + lumaSize + chromaSize * 2);
+	std::copy(header, header + sizeof(header) - 1, data.begin());
+	auto luma = data.data() + sizeof(header) - 1;
+	auto blue = luma + lumaSize;
+	auto red = blue + chromaSize;
+	auto pixels = static_cast<const Uint8*>(frame->pixels);
+	for (auto y = 0; y < frameHeight; ++y) {
+		auto row = pixels + (size_t)y * frame->pitch;
+		for (auto x = 0; x < frameWidth; ++x) {
+			auto source = row + (size_t)x * 4;
+			luma[(size_t)y * frameWidth + x] = (Uint8)((66 * source[0] + 129 * source[1] + 25 * source[2] + 4224) >> 8);
+		}
+	}
+	for (auto y = 0; y < frameHeight / 2; ++y) {
+		auto top = pixels + (size_t)y * 2 * frame->pitch;
+		auto bottom = top + frame->pitch;
+		for (auto x = 0; x < chromaWidth; ++x) {
+			int sum[3] = {};
+			for (auto c = 0; c < 3; ++c)
+				sum[c] = top[x * 8 + c] + top[x * 8 + 4 + c] + bottom[x * 8 + c] + bottom[x * 8 + 4 + c];
+			blue[(size_t)y * chromaWidth + x] = (Uint8)((-38 * sum[0] - 74 * sum[1] + 112 * sum[2] + 131584) >> 10);
+			red[(size_t)y * chromaWidth + x] = (Uint8)((112 * sum[0] - 94 * sum[1] - 18 * sum[2] + 131584) >> 10);
+		}
+	}
+}
+
+bool Clip::writeData(FILE* file, const std::vector<Uint8>& data) {
+	return std::fwrite(data.data(), 1, data.size(), file) == data.size();
+}
+
+FILE* Clip::openStream(const std::filesystem::path& path) {
+	if (path != "-") return std::fopen(path.string().c_str(), "wb");
+#ifdef WIN32
+	_setmode(_fileno(stdout), _O_BINARY);
+#endif
+	return stdout;
+}
+
+int Clip::exportZoom(const std::vector<std::filesystem::path>& files,
+	const std::function<SDL_Surface*(const std::filesystem::path&)>& loadColorDepth) {
+	if (files.empty() || frameCount <= 0 || frameRate <= 0) return -1;
+	auto toStream = format == Clip_Y4m || output == "-";
+	if (!toStream) {
+		std::error_code errorCode;
+		std::filesystem::create_directories(output, errorCode);
+	}
+	auto threadCount = frameThreads > 0 ? frameThreads : (int)std::thread::hardware_concurrency();
+	threadCount = std::clamp(threadCount, 1, frameCount);
+
+	FILE* stream = nullptr;
+	auto frameWidth = width, frameHeight = height;
+	auto written = 0;
+	for (size_t index = 0; index < files.size(); ++index) {
+		auto colorDepth = loadColorDepth(files[index]);
+		if (colorDepth == nullptr) {
+			SDL_Log("Skipped Zoom Export: %s.", files[index].string().c_str());
+			continue;
+		}
+		if (frameWidth <= 0 || frameHeight <= 0) {
+			frameWidth = colorDepth->w / 2;
+			frameHeight = colorDepth->h;
+		}
+		if (format == Clip_Y4m) {
+			frameWidth = std::max(frameWidth & ~1, 2);
+			frameHeight = std::max(frameHeight & ~1, 2);
+		}
+		if (toStream && stream == nullptr) {
+			stream = openStream(output);
+			if (stream == nullptr) {
+				SDL_Log("Could Not Open Zoom Output: %s.", output.string().c_str());
+				SDL_DestroySurface(colorDepth);
+				return -1;
+			}
+			if (format == Clip_Y4m) {
+				auto header = std::format("YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C420jpeg\n", frameWidth, frameHeight,
+					frameRate);
+				std::fwrite(header.data(), 1, header.size(), stream);
+			}
+		}
+
+		auto rect = Render::getFitRect(colorDepth, frameWidth, frameHeight);
+		auto imageEffect = effect >= 0 ? effect : (int)(index % 2);
+		auto stem = files[index].stem().string();
+		std::vector<std::vector<Uint8>> frames(threadCount);
+		auto failed = false;
+		for (auto first = 0; first < frameCount && !failed; first += threadCount) {
+			auto count = std::min(threadCount, frameCount - first);
+			std::atomic<int> next = 0;
+			auto work = [&]() {
+				auto frame = SDL_CreateSurface(frameWidth, frameHeight, SDL_PIXELFORMAT_ABGR8888);
+				for (auto slot = next++; slot < count; slot = next++) {
+					frames[slot].clear();
+					if (frame == nullptr) continue;
+					auto depthEffect = frameCount > 1 ? (float)(first + slot) / (float)(frameCount - 1) : 1.0f;
+					if (Render::renderZoom(colorDepth, frame, &rect, depthEffect, imageEffect) == 0)
+						convertFrame(frame, frames[slot]);
+				}
+				SDL_DestroySurface(frame);
+			};
+			std::vector<std::thread> threads;
+			for (auto i = 1; i < count; ++i) threads.emplace_back(work);
+			work();
+			for (auto& thread : threads) thread.join();
+
+			for (auto slot = 0; slot < count && !failed; ++slot) {
+				if (frames[slot].empty()) {
+					failed = true;
+				} else if (toStream) {
+					failed = !writeData(stream, frames[slot]);
+				} else {
+					auto path = output / std::format("{}_zoom_{:04}.png", stem, first + slot);
+					auto file = std::fopen(path.string().c_str(), "wb");
+					failed = file == nullptr || !writeData(file, frames[slot]);
+					if (file != nullptr) std::fclose(file);
+				}
+			}
+		}
+		SDL_DestroySurface(colorDepth);
+		if (failed) {
+			SDL_Log("Zoom Export Failed: %s.", files[index].string().c_str());
+			break;
+		}
+		++written;
+		SDL_Log("Exported Zoom %s.", stem.c_str());
+	}
+
+	if (stream != nullptr && stream != stdout) std::fclose(stream);
+	else if (stream != nullptr) std::fflush(stream);
+	return written > 0 && written == (int)files.size() ? 0 : -1;
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RENDEPTH_CLIP_H
+#define RENDEPTH_CLIP_H
+
+#include <SDL3/SDL.h>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+enum ClipFormat {
+	Clip_Y4m = 0,
+	Clip_Png = 1
+};
+
+class Clip {
+public:
+	static int exportZoom(const std::vector<std::filesystem::path>& files,
+		const std::function<SDL_Surface*(const std::filesystem::path&)>& loadColorDepth);
+	inline static std::filesystem::path output = "-";
+	inline static ClipFormat format = Clip_Y4m;
+	inline static int frameCount = 48;
+	inline static int frameRate = 24;
+	inline static int effect = -1;
+	inline static int width = 0;
+	inline static int height = 0;
+	inline static int frameThreads = 0;
+private:
+	static void convertFrame(const SDL_Surface* frame, std::vector<Uint8>& data);
+	static bool writeData(FILE* file, const std::vector<Uint8>& data);
+	static FILE* openStream(const std::filesystem::path& path);
+};
+
+#endif
\ No newline at end of file
@@ -20,9 +20,13 @@
 
 #include "Core.h"
 #include "Image.h"
+#include "Depth.h"
 #include "SDL3_image/SDL_image.h"
 #include <thread>
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <regex>
 
 void Core::quit(Context* context) {
 	SDL_ReleaseWindowFromGPUDevice(context->device, context->window);
@@ -182,6 +186,38 @@ SDL_Surface* Core::loadImageDirect(const std::string& imageFilename) {
 	return surface;
 }
 
+SDL_Surface* Core::loadImageMemory(const void* data, size_t size) {
+	SDL_Surface* surface = IMG_Load_IO(SDL_IOFromConstMem(data, size), true);
+	if (surface == nullptr) return nullptr;
+
+	SDL_PixelFormat format = SDL_PIXELFORMAT_ABGR8888;
+	if (surface->format != format) {
+		SDL_Surface* next = SDL_ConvertSurface(surface, format);
+		SDL_DestroySurface(surface);
+		surface = next;
+	}
+
+	return surface;
+}
+
+SDL_Surface* Core::composeColorDepth(const SDL_Surface* color, const std::vector<Uint8>& depth,
+	glm::ivec2 depthSize) {
+	if (depthSize.x <= 0 || depthSize.y <= 0 || depth.size() < (size_t)depthSize.x * depthSize.y) return nullptr;
+	SDL_Surface* surface = SDL_CreateSurface(color->w * 2, color->h, SDL_PIXELFORMAT_ABGR8888);
+	if (surface == nullptr) return nullptr;
+
+	for (auto y = 0; y < color->h; ++y) {
+		std::memcpy(static_cast<Uint8*>(surface->pixels) + (size_t)y * surface->pitch,
+			static_cast<const Uint8*>(color->pixels) + (size_t)y * color->pitch, (size_t)color->w * 4);
+	}
+	if (Depth::upsample(color, depth, depthSize, surface, color->w) != 0) {
+		SDL_DestroySurface(surface);
+		return nullptr;
+	}
+
+	return surface;
+}
+
 int Core::loadImageThread(void* ptr) {
 	auto data = static_cast<AsyncData*>(ptr);
 	SDL_DestroySurface((*data).surface);
@@ -221,6 +257,18 @@ StereoFormat Core::getImageType(const std::string& file) {
 	return result;
 }
 
+std::string Core::removeFileTags(const std::string& fileName) {
+	std::string tagPattern = "(";
+	for (auto& tag : tagType) {
+		if (tag.second != Side_By_Side_Swap)
+			tagPattern += tag.first + "|";
+	}
+	tagPattern.pop_back();
+	tagPattern += ")";
+	std::regex pattern(tagPattern);
+	return std::regex_replace(fileName, pattern, "");
+}
+
 glm::vec3 Core::getGridInfo(const std::string& file) {
 	auto result = glm::vec3(1, 1, 1);
 	std::size_t gridTag = file.find("_qs");
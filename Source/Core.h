@@ -157,6 +157,7 @@ struct Choice {
 	MenuLayout layout;
 	std::vector<MenuLayout> layouts;
 	bool active;
+	bool disabled;
 };
 
 struct OptionsTexture {
@@ -243,6 +244,10 @@ struct FileInfo {
 	StereoFormat type;
 	StereoFormat preloadType;
 	SDL_Surface* preload;
+	std::vector<Uint8> depth;
+	glm::ivec2 depthSize;
+	std::string cacheKey;
+	bool provisional;
 };
 
 struct AsyncData {
@@ -258,11 +263,15 @@ public:
 	static SDL_GPUShader* loadShader(SDL_GPUDevice* device, const std::string& shaderFilename, Uint32 samplerCount,
 		Uint32 uniformBufferCount, Uint32 storageBufferCount, Uint32 storageTextureCount);
 	static SDL_Surface* loadImageDirect(const std::string& imageFilename);
+	static SDL_Surface* loadImageMemory(const void* data, size_t size);
+	static SDL_Surface* composeColorDepth(const SDL_Surface* color, const std::vector<Uint8>& depth,
+		glm::ivec2 depthSize);
 	static int loadImageThread(void* ptr);
 	static SDL_Thread* loadImageAsync(AsyncData& asyncData);
 	static glm::vec2 getTextSize(TTF_Font* font, const std::string& text);
 	static std::string getFileText(const FileInfo& imageInfo, glm::vec2 imageSize);
 	static StereoFormat getImageType(const std::string& file);
+	static std::string removeFileTags(const std::string& fileName);
 	static glm::vec3 getGridInfo(const std::string& file);
 	static void drawText(Context* context, const std::string& text, TTF_Font* font,
 		SDL_GPUTexture*& texture, glm::vec2& size, const std::string& name);
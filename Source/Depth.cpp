@@ -0,0 +1,365 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Depth.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <thread>
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+void Depth::boxFilter(std::vector<float>& plane, int width, int height, int radius) {
+	std::vector<float> sums((size_t)std::max(width, height) + 1);
+	std::vector<float> line((size_t)std::max(width, height));
+	auto filterLine = [&](float* data, int count, int stride) {
+		sums[0] = 0.0f;
+		for (auto i = 0; i < count; ++i) sums[i + 1] = sums[i] + data[(size_t)i * stride];
+		for (auto i = 0; i < count; ++i) {
+			auto start = std::max(i - radius, 0);
+			auto end = std::min(i + radius + 1, count);
+			line[i] = (sums[end] - sums[start]) / (float)(end - start);
+		}
+		for (auto i = 0; i < count; ++i) data[(size_t)i * stride] = line[i];
+	};
+	for (auto y = 0; y < height; ++y) filterLine(plane.data() + (size_t)y * width, width, 1);
+	for (auto x = 0; x < width; ++x) filterLine(plane.data() + x, height, width);
+}
+
+int Depth::estimate(const SDL_Surface* color, std::vector<Uint8>& depth, glm::ivec2& depthSize) {
+	if (color == nullptr || color->format != SDL_PIXELFORMAT_ABGR8888 || color->w <= 0 || color->h <= 0) return -1;
+	auto block = std::max((std::max(color->w, color->h) + previewSize - 1) / previewSize, 1);
+	auto width = (color->w + block - 1) / block;
+	auto height = (color->h + block - 1) / block;
+	auto size = (size_t)width * height;
+
+	std::vector<Uint32> sums(size, 0), counts(size, 0);
+	std::vector<Uint64> squares(size, 0);
+	for (auto y = 0; y < color->h; ++y) {
+		auto source = static_cast<const Uint8*>(color->pixels) + (size_t)y * color->pitch;
+		auto row = (size_t)(y / block) * width;
+		for (auto cell = row; cell < row + width; ++cell) {
+			auto count = std::min(block, (int)(color->w - (cell - row) * block));
+			Uint32 sum = 0, square = 0;
+			for (auto x = 0; x < count; ++x, source += 4) {
+				auto luma = (Uint32)(77 * source[0] + 150 * source[1] + 29 * source[2]) >> 8;
+				sum += luma;
+				square += luma * luma;
+			}
+			sums[cell] += sum;
+			squares[cell] += square;
+			counts[cell] += count;
+		}
+	}
+
+	std::vector<float> guide(size), focus(size);
+	for (size_t i = 0; i < size; ++i) {
+		auto mean = (float)sums[i] / (float)counts[i];
+		guide[i] = mean / 255.0f;
+		focus[i] = std::sqrt(std::max((float)squares[i] / (float)counts[i] - mean * mean, 0.0f)) / 255.0f;
+	}
+	for (auto y = 0; y < height; ++y) {
+		for (auto x = 0; x < width; ++x) {
+			auto i = (size_t)y * width + x;
+			auto gradientX = guide[(size_t)y * width + std::min(x + 1, width - 1)] - guide[(size_t)y * width + std::max(x - 1, 0)];
+			auto gradientY = guide[(size_t)std::min(y + 1, height - 1) * width + x] - guide[(size_t)std::max(y - 1, 0) * width + x];
+			focus[i] += 0.5f * std::sqrt(gradientX * gradientX + gradientY * gradientY);
+		}
+	}
+
+	std::vector<float> sorted(focus);
+	auto percentile = sorted.begin() + (ptrdiff_t)(sorted.size() * 95 / 100);
+	std::nth_element(sorted.begin(), percentile, sorted.end());
+	auto focusScale = *percentile > 0.0f ? 1.0f / *percentile : 0.0f;
+	for (auto& value : focus) value = std::min(value * focusScale, 1.0f);
+	boxFilter(focus, width, height, std::max((int)(std::max(width, height) * focusSpread), 1));
+
+	std::vector<float> plane(size);
+	for (auto y = 0; y < height; ++y) {
+		auto vertical = ((float)y + 0.5f) / (float)height;
+		for (auto x = 0; x < width; ++x) {
+			auto i = (size_t)y * width + x;
+			plane[i] = verticalWeight * vertical + (1.0f - verticalWeight) * focus[i];
+		}
+	}
+
+	auto radius = std::max((int)(std::max(width, height) * filterRadius), 1);
+	std::vector<float> meanGuide(guide), meanPlane(plane), guidePlane(size), guideSquare(size);
+	for (size_t i = 0; i < size; ++i) {
+		guidePlane[i] = guide[i] * plane[i];
+		guideSquare[i] = guide[i] * guide[i];
+	}
+	boxFilter(meanGuide, width, height, radius);
+	boxFilter(meanPlane, width, height, radius);
+	boxFilter(guidePlane, width, height, radius);
+	boxFilter(guideSquare, width, height, radius);
+	for (size_t i = 0; i < size; ++i) {
+		auto variance = guideSquare[i] - meanGuide[i] * meanGuide[i];
+		auto slope = (guidePlane[i] - meanGuide[i] * meanPlane[i]) / (variance + filterEpsilon);
+		guidePlane[i] = slope;
+		guideSquare[i] = meanPlane[i] - slope * meanGuide[i];
+	}
+	boxFilter(guidePlane, width, height, radius);
+	boxFilter(guideSquare, width, height, radius);
+
+	for (size_t i = 0; i < size; ++i) plane[i] = guidePlane[i] * guide[i] + guideSquare[i];
+	auto [low, high] = std::minmax_element(plane.begin(), plane.end());
+	auto minimum = *low;
+	auto range = std::max(*high - minimum, 1e-3f);
+	depth.resize(size);
+	for (size_t i = 0; i < size; ++i)
+		depth[i] = (Uint8)std::clamp((plane[i] - minimum) / range * 255.0f + 0.5f, 0.0f, 255.0f);
+	depthSize = { width, height };
+	return 0;
+}
+
+void Depth::parallelRows(int rows, const std::function<void(int, int)>& work) {
+	auto threadCount = upsampleThreads > 0 ? upsampleThreads : (int)std::thread::hardware_concurrency();
+	threadCount = std::clamp(threadCount, 1, std::max(rows / 16, 1));
+	if (threadCount == 1) {
+		work(0, rows);
+		return;
+	}
+	std::vector<std::thread> threads;
+	auto band = (rows + threadCount - 1) / threadCount;
+	for (auto start = band; start < rows; start += band)
+		threads.emplace_back(work, start, std::min(start + band, rows));
+	work(0, std::min(band, rows));
+	for (auto& thread : threads) thread.join();
+}
+
+int Depth::upsample(const SDL_Surface* color, const std::vector<Uint8>& depth, glm::ivec2 depthSize,
+	SDL_Surface* target, int targetX) {
+	if (color == nullptr || target == nullptr || color->format != SDL_PIXELFORMAT_ABGR8888 ||
+		depthSize.x <= 0 || depthSize.y <= 0 || depth.size() < (size_t)depthSize.x * depthSize.y ||
+		targetX + color->w > target->w || color->h > target->h) return -1;
+	auto width = depthSize.x, height = depthSize.y;
+
+	std::vector<Uint16> samples((size_t)width * height);
+	parallelRows(height, [&](int first, int last) {
+		for (auto v = first; v < last; ++v) {
+			auto top = (int)((Sint64)v * color->h / height);
+			auto bottom = std::max((int)((Sint64)(v + 1) * color->h / height), top + 1);
+			for (auto u = 0; u < width; ++u) {
+				auto left = (int)((Sint64)u * color->w / width);
+				auto right = std::max((int)((Sint64)(u + 1) * color->w / width), left + 1);
+				Uint32 sum = 0;
+				for (auto y = top; y < bottom; ++y) {
+					auto source = static_cast<const Uint8*>(color->pixels) + (size_t)y * color->pitch + (size_t)left * 4;
+					for (auto x = left; x < right; ++x, source += 4)
+						sum += (77 * source[0] + 150 * source[1] + 29 * source[2]) >> 8;
+				}
+				auto index = (size_t)v * width + u;
+				samples[index] = (Uint16)((sum / (Uint32)((bottom - top) * (right - left))) << 8 | depth[index]);
+			}
+		}
+	});
+
+	std::vector<Uint8> smooth((size_t)width * height);
+	parallelRows(height, [&](int first, int last) {
+		for (auto v = first; v < last; ++v) {
+			for (auto u = 0; u < width; ++u) {
+				int guideLow = 255, guideHigh = 0, depthLow = 255, depthHigh = 0;
+				for (auto j = std::max(v - 1, 0); j <= std::min(v + 1, height - 1); ++j) {
+					for (auto k = std::max(u - 1, 0); k <= std::min(u + 1, width - 1); ++k) {
+						auto sample = samples[(size_t)j * width + k];
+						guideLow = std::min(guideLow, sample >> 8);
+						guideHigh = std::max(guideHigh, sample >> 8);
+						depthLow = std::min(depthLow, sample & 0xFF);
+						depthHigh = std::max(depthHigh, sample & 0xFF);
+					}
+				}
+				smooth[(size_t)v * width + u] = guideHigh - guideLow <= smoothGuide || depthHigh - depthLow <= smoothDepth;
+			}
+		}
+	});
+
+	std::array<float, 511> rangeTable{};
+	for (auto i = -255; i <= 255; ++i)
+		rangeTable[i + 255] = std::max(std::exp(-(float)(i * i) / (2.0f * rangeSigma * rangeSigma)), rangeFloor);
+	struct Taps {
+		std::array<std::vector<int>, 3> index;
+		std::array<std::vector<float>, 3> weight;
+		std::vector<int> linear;
+		std::vector<int> next;
+		std::vector<float> fraction;
+	};
+	auto getTaps = [](int count, int size) {
+		Taps taps;
+		for (auto k = 0; k < 3; ++k) {
+			taps.index[k].resize(count);
+			taps.weight[k].resize(count);
+		}
+		taps.linear.resize(count);
+		taps.next.resize(count);
+		taps.fraction.resize(count);
+		auto scale = (float)size / (float)count;
+		for (auto i = 0; i < count; ++i) {
+			auto position = std::clamp(((float)i + 0.5f) * scale - 0.5f, 0.0f, (float)(size - 1));
+			auto center = (int)std::lround(position);
+			for (auto k = 0; k < 3; ++k) {
+				auto offset = position - (float)(center + k - 1);
+				taps.index[k][i] = std::clamp(center + k - 1, 0, size - 1);
+				taps.weight[k][i] = std::exp(-offset * offset / (2.0f * spatialSigma * spatialSigma));
+			}
+			taps.linear[i] = std::min((int)position, size - 1);
+			taps.next[i] = std::min(taps.linear[i] + 1, size - 1);
+			taps.fraction[i] = position - (float)taps.linear[i];
+		}
+		return taps;
+	};
+	auto columns = getTaps(color->w, width);
+	auto rows = getTaps(color->h, height);
+
+	parallelRows(color->h, [&](int first, int last) {
+#ifdef __AVX__
+		const auto planeCount = 9;
+		std::vector<float> expanded((size_t)4 * planeCount * color->w);
+		std::array<int, 4> expandedRows = { -1, -1, -1, -1 };
+		auto expandRow = [&](int row) {
+			auto planes = expanded.data() + (size_t)(row & 3) * planeCount * color->w;
+			if (expandedRows[row & 3] == row) return planes;
+			expandedRows[row & 3] = row;
+			auto sampleRow = samples.data() + (size_t)row * width;
+			auto smoothRow = smooth.data() + (size_t)row * width;
+			for (auto x = 0; x < color->w; ++x) {
+				for (auto k = 0; k < 3; ++k) {
+					auto sample = sampleRow[columns.index[k][x]];
+					planes[(size_t)k * color->w + x] = (float)(sample >> 8);
+					planes[(size_t)(k + 3) * color->w + x] = (float)(sample & 0xFF);
+				}
+				planes[(size_t)6 * color->w + x] = (float)(sampleRow[columns.linear[x]] & 0xFF);
+				planes[(size_t)7 * color->w + x] = (float)(sampleRow[columns.next[x]] & 0xFF);
+				planes[(size_t)8 * color->w + x] = smoothRow[columns.index[1][x]];
+			}
+			return planes;
+		};
+		auto rangeScale = _mm256_set1_ps(-1.0f / (32.0f * rangeSigma * rangeSigma));
+		auto rangeLow = _mm256_set1_ps(std::log(rangeFloor) / 16.0f);
+		auto getRangeWeights = [&](__m256 difference) {
+			auto power = _mm256_max_ps(_mm256_mul_ps(_mm256_mul_ps(difference, difference), rangeScale), rangeLow);
+			auto weight = _mm256_set1_ps(1.0f / 5040.0f);
+			for (auto term : { 720.0f, 120.0f, 24.0f, 6.0f, 2.0f, 1.0f, 1.0f })
+				weight = _mm256_add_ps(_mm256_mul_ps(weight, power), _mm256_set1_ps(1.0f / term));
+			for (auto i = 0; i < 4; ++i) weight = _mm256_mul_ps(weight, weight);
+			return weight;
+		};
+#endif
+		for (auto y = first; y < last; ++y) {
+			auto source = static_cast<const Uint8*>(color->pixels) + (size_t)y * color->pitch;
+			auto output = reinterpret_cast<Uint32*>(static_cast<Uint8*>(target->pixels) +
+				(size_t)y * target->pitch) + targetX;
+			const Uint16* sampleRows[3];
+			for (auto k = 0; k < 3; ++k) sampleRows[k] = samples.data() + (size_t)rows.index[k][y] * width;
+			auto smoothRow = smooth.data() + (size_t)rows.index[1][y] * width;
+			float rowWeight[3] = { rows.weight[0][y], rows.weight[1][y], rows.weight[2][y] };
+			auto linearTop = samples.data() + (size_t)rows.linear[y] * width;
+			auto linearBottom = samples.data() + (size_t)rows.next[y] * width;
+			auto fractionY = rows.fraction[y];
+			auto x = 0;
+#ifdef __AVX__
+			const float* tapPlanes[3];
+			for (auto j = 0; j < 3; ++j) tapPlanes[j] = expandRow(rows.index[j][y]);
+			auto smoothPlane = expandRow(rows.index[1][y]) + (size_t)8 * color->w;
+			auto topPlane = expandRow(rows.linear[y]) + (size_t)6 * color->w;
+			auto bottomPlane = expandRow(rows.next[y]) + (size_t)6 * color->w;
+			for (; x + 8 <= color->w; x += 8, source += 32) {
+				auto smoothMask = _mm256_cmp_ps(_mm256_loadu_ps(smoothPlane + x), _mm256_setzero_ps(), _CMP_GT_OQ);
+				auto smoothBits = _mm256_movemask_ps(smoothMask);
+				auto value = _mm256_setzero_ps();
+				if (smoothBits != 0) {
+					auto fractionX = _mm256_loadu_ps(columns.fraction.data() + x);
+					auto lerp = [&](const float* plane) {
+						auto left = _mm256_loadu_ps(plane + x);
+						auto right = _mm256_loadu_ps(plane + color->w + x);
+						return _mm256_add_ps(left, _mm256_mul_ps(_mm256_sub_ps(right, left), fractionX));
+					};
+					auto top = lerp(topPlane), bottom = lerp(bottomPlane);
+					value = _mm256_add_ps(top, _mm256_mul_ps(_mm256_sub_ps(bottom, top), _mm256_set1_ps(fractionY)));
+				}
+				if (smoothBits != 0xFF) {
+					auto pixels = _mm256_loadu_ps(reinterpret_cast<const float*>(source));
+					auto channel = [&](Uint32 mask, float scale) {
+						auto bits = _mm256_and_ps(pixels, _mm256_castsi256_ps(_mm256_set1_epi32((int)mask)));
+						return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_castps_si256(bits)), _mm256_set1_ps(scale));
+					};
+					auto guide = _mm256_add_ps(_mm256_add_ps(channel(0xFF, 77.0f), channel(0xFF00, 150.0f / 256.0f)),
+						channel(0xFF0000, 29.0f / 65536.0f));
+					guide = _mm256_floor_ps(_mm256_mul_ps(guide, _mm256_set1_ps(1.0f / 256.0f)));
+					auto total = _mm256_setzero_ps(), weights = _mm256_setzero_ps();
+					for (auto j = 0; j < 3; ++j) {
+						auto partTotal = _mm256_setzero_ps(), partWeights = _mm256_setzero_ps();
+						for (auto k = 0; k < 3; ++k) {
+							auto sampleGuide = _mm256_loadu_ps(tapPlanes[j] + (size_t)k * color->w + x);
+							auto sampleDepth = _mm256_loadu_ps(tapPlanes[j] + (size_t)(k + 3) * color->w + x);
+							auto weight = _mm256_mul_ps(_mm256_loadu_ps(columns.weight[k].data() + x),
+								getRangeWeights(_mm256_sub_ps(guide, sampleGuide)));
+							partTotal = _mm256_add_ps(partTotal, _mm256_mul_ps(weight, sampleDepth));
+							partWeights = _mm256_add_ps(partWeights, weight);
+						}
+						auto weightJ = _mm256_set1_ps(rowWeight[j]);
+						total = _mm256_add_ps(total, _mm256_mul_ps(weightJ, partTotal));
+						weights = _mm256_add_ps(weights, _mm256_mul_ps(weightJ, partWeights));
+					}
+					value = _mm256_blendv_ps(_mm256_div_ps(total, weights), value, smoothMask);
+				}
+				auto level = _mm256_round_ps(_mm256_min_ps(_mm256_max_ps(_mm256_add_ps(value, _mm256_set1_ps(0.5f)),
+					_mm256_setzero_ps()), _mm256_set1_ps(255.0f)), _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+				auto gray = _mm256_cvttps_epi32(_mm256_mul_ps(level, _mm256_set1_ps(65793.0f)));
+				_mm256_storeu_ps(reinterpret_cast<float*>(output + x), _mm256_or_ps(_mm256_castsi256_ps(gray),
+					_mm256_castsi256_ps(_mm256_set1_epi32((int)0xFF000000u))));
+			}
+#endif
+			for (; x < color->w; ++x, source += 4) {
+				auto value = 0.0f;
+				if (smoothRow[columns.index[1][x]]) {
+					auto left = columns.linear[x];
+					auto right = columns.next[x];
+					auto fractionX = columns.fraction[x];
+					auto top = (float)(linearTop[left] & 0xFF) + ((float)(linearTop[right] & 0xFF) -
+						(float)(linearTop[left] & 0xFF)) * fractionX;
+					auto bottom = (float)(linearBottom[left] & 0xFF) + ((float)(linearBottom[right] & 0xFF) -
+						(float)(linearBottom[left] & 0xFF)) * fractionX;
+					value = top + (bottom - top) * fractionY;
+				} else {
+					auto range = rangeTable.data() + 255 + ((77 * source[0] + 150 * source[1] + 29 * source[2]) >> 8);
+					auto total = 0.0f, weights = 0.0f;
+					for (auto j = 0; j < 3; ++j) {
+						auto sampleRow = sampleRows[j];
+						auto partTotal = 0.0f, partWeights = 0.0f;
+						for (auto k = 0; k < 3; ++k) {
+							auto sample = sampleRow[columns.index[k][x]];
+							auto weight = columns.weight[k][x] * range[-(int)(sample >> 8)];
+							partTotal += weight * (float)(sample & 0xFF);
+							partWeights += weight;
+						}
+						total += rowWeight[j] * partTotal;
+						weights += rowWeight[j] * partWeights;
+					}
+					value = total / weights;
+				}
+				auto level = (Uint32)std::clamp(value + 0.5f, 0.0f, 255.0f);
+				output[x] = 0xFF000000u | (level << 16) | (level << 8) | level;
+			}
+		}
+	});
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RENDEPTH_DEPTH_H
+#define RENDEPTH_DEPTH_H
+
+#include <SDL3/SDL.h>
+#include "glm/glm.hpp"
+#include <functional>
+#include <vector>
+
+class Depth {
+public:
+	static int estimate(const SDL_Surface* color, std::vector<Uint8>& depth, glm::ivec2& depthSize);
+	static int upsample(const SDL_Surface* color, const std::vector<Uint8>& depth, glm::ivec2 depthSize,
+		SDL_Surface* target, int targetX);
+	inline static bool usePreview = true;
+	inline static int previewSize = 320;
+	inline static float verticalWeight = 0.55f;
+	inline static float focusSpread = 0.06f;
+	inline static float filterRadius = 0.025f;
+	inline static float filterEpsilon = 0.01f;
+	inline static float spatialSigma = 0.75f;
+	inline static float rangeSigma = 12.0f;
+	inline static float rangeFloor = 0.001f;
+	inline static int smoothGuide = 6;
+	inline static int smoothDepth = 1;
+	inline static int upsampleThreads = 0;
+private:
+	static void boxFilter(std::vector<float>& plane, int width, int height, int radius);
+	static void parallelRows(int rows, const std::function<void(int, int)>& work);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,334 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Export.h"
+#include "Mp4.h"
+#include <SDL3_image/SDL_image.h>
+#include <algorithm>
+#include <cstring>
+
+int Export::submit(Context* context, const std::vector<ExportTarget>& targets, const std::string& displayName,
+	const ExportPreset& preset) {
+	if (targets.empty()) return -1;
+	if (!running && start() != 0) return -1;
+	std::vector<StereoFormat> formats;
+	for (const auto& target : targets) formats.push_back(target.format);
+	std::vector<ExportReadback> readbacks;
+	if (Image::renderStereoImages(context, formats, readbacks, preset.parameters, preset.background) != 0) return -1;
+
+	ExportJob job{ nextJobId++, Export_Active, displayName, preset.quality, {}, (int)targets.size(), SDL_GetTicks() };
+	job.outputs.resize(targets.size());
+	for (size_t i = 0; i < targets.size(); ++i) {
+		auto& output = job.outputs[i];
+		output.target = targets[i];
+		output.readback = readbacks[i];
+		prepare(output, preset.quality);
+	}
+	std::lock_guard lock(jobMutex);
+	return jobs.emplace_back(std::move(job)).id;
+}
+
+void Export::update(Context* context) {
+	std::lock_guard lock(jobMutex);
+	for (auto it = jobs.begin(); it != jobs.end();) {
+		auto& job = *it;
+		for (size_t i = 0; i < job.outputs.size(); ++i) updateOutput(context, job, i);
+		if (job.state == Export_Done) {
+			for (auto& output : job.outputs) release(context, output);
+			it = jobs.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+bool Export::poll(ExportResult& result) {
+	std::lock_guard lock(jobMutex);
+	if (results.empty()) return false;
+	result = std::move(results.front());
+	results.pop_front();
+	return true;
+}
+
+int Export::getPendingCount() {
+	std::lock_guard lock(jobMutex);
+	auto pending = 0;
+	for (const auto& job : jobs) pending += job.remaining;
+	return pending;
+}
+
+void Export::close(Context* context) {
+	while (getPendingCount() > 0) {
+		update(context);
+		SDL_Delay(closeDelay);
+	}
+	update(context);
+	{
+		std::lock_guard lock(jobMutex);
+		running = false;
+	}
+	readSignal.notify_all();
+	writeSignal.notify_all();
+	for (auto thread : threads) SDL_WaitThread(thread, nullptr);
+	threads.clear();
+}
+
+int Export::start() {
+	running = true;
+	auto writeThreads = ioThreads > 0 ? ioThreads : std::clamp(SDL_GetNumLogicalCPUCores() / 2, 1, 4);
+	threads.push_back(SDL_CreateThread(readRun, "exportReadRun", nullptr));
+	for (auto i = 0; i < writeThreads; ++i)
+		threads.push_back(SDL_CreateThread(writeRun, "exportWriteRun", nullptr));
+	if (std::find(threads.begin(), threads.end(), nullptr) != threads.end()) {
+		SDL_Log("Create Export Thread Failed.");
+		running = false;
+		readSignal.notify_all();
+		writeSignal.notify_all();
+		for (auto thread : threads) if (thread != nullptr) SDL_WaitThread(thread, nullptr);
+		threads.clear();
+		return -1;
+	}
+	return 0;
+}
+
+int Export::readRun(void* ptr) {
+	while (true) {
+		ExportTask task;
+		{
+			std::unique_lock lock(jobMutex);
+			readSignal.wait(lock, [] { return !running || !readQueue.empty(); });
+			if (readQueue.empty()) return 0;
+			task = readQueue.front();
+			readQueue.pop_front();
+		}
+		auto& output = task.job->outputs[task.output];
+		auto& slot = output.slots[task.slot];
+		auto surface = copyRows(output, slot);
+		std::lock_guard lock(jobMutex);
+		slot.surface = surface;
+		slot.state = Slot_Copied;
+	}
+}
+
+int Export::writeRun(void* ptr) {
+	while (true) {
+		ExportTask task;
+		{
+			std::unique_lock lock(jobMutex);
+			writeSignal.wait(lock, [] { return !running || !writeQueue.empty(); });
+			if (writeQueue.empty()) return 0;
+			task = writeQueue.front();
+			writeQueue.pop_front();
+		}
+		auto& job = *task.job;
+		auto& output = job.outputs[task.output];
+		if (task.chunk >= 0) {
+			auto encoded = encodeChunk(output, task.chunk, task.surface);
+			SDL_DestroySurface(task.surface);
+			std::lock_guard lock(jobMutex);
+			if (!encoded) output.failed = true;
+			--output.activeChunks;
+			completeChunk(job, task.output);
+			continue;
+		}
+
+		auto error = output.failed || !encode(output, job.quality);
+		SDL_DestroySurface(output.surface);
+		output.surface = nullptr;
+		std::lock_guard lock(jobMutex);
+		finish(job, output, error);
+	}
+}
+
+void Export::prepare(ExportOutput& output, int quality) {
+	auto width = output.readback.width;
+	auto height = output.readback.height;
+	auto png = output.target.encoding == Encoding_Png;
+	output.jpegStream = (!png && useStripedJpeg) || !output.target.videoPath.empty();
+	output.streamed = png || output.jpegStream;
+	if (!output.streamed) output.chunkRows = height;
+	else if (output.jpegStream) output.chunkRows = Jpeg::getStripeRows(width, chunkRows);
+	else output.chunkRows = std::max(chunkRows, 1);
+	output.chunkCount = (height + output.chunkRows - 1) / output.chunkRows;
+	if (png && Png::begin(output.png, width, height, output.chunkRows) != 0) output.failed = true;
+	if (output.jpegStream && Jpeg::begin(output.jpeg, width, height, quality, output.chunkRows) != 0)
+		output.failed = true;
+}
+
+void Export::updateOutput(Context* context, ExportJob& job, size_t index) {
+	auto& output = job.outputs[index];
+	if (output.done) return;
+	for (auto i = 0; i < 2; ++i) {
+		auto& slot = output.slots[i];
+		if (slot.state == Slot_Downloading && SDL_QueryGPUFence(context->device, slot.fence)) {
+			SDL_ReleaseGPUFence(context->device, slot.fence);
+			slot.fence = nullptr;
+			slot.mapped = (Uint8*)SDL_MapGPUTransferBuffer(context->device, slot.transferBuffer, false);
+			if (slot.mapped == nullptr) {
+				slot.state = Slot_Idle;
+				output.failed = true;
+				--output.activeChunks;
+				completeChunk(job, index);
+			} else {
+				slot.state = Slot_Copying;
+				readQueue.push_back({ &job, index, slot.chunk, i, nullptr });
+				readSignal.notify_one();
+			}
+		} else if (slot.state == Slot_Copied) {
+			SDL_UnmapGPUTransferBuffer(context->device, slot.transferBuffer);
+			slot.mapped = nullptr;
+			slot.state = Slot_Idle;
+			writeQueue.push_back({ &job, index, slot.chunk, i, slot.surface });
+			slot.surface = nullptr;
+			writeSignal.notify_one();
+		}
+	}
+
+	for (auto& slot : output.slots) {
+		if (output.failed || output.nextChunk >= output.chunkCount || output.activeChunks >= maxActiveChunks) break;
+		if (slot.state != Slot_Idle) continue;
+		slot.chunk = output.nextChunk++;
+		++output.activeChunks;
+		if (download(context, output, slot) == 0) {
+			slot.state = Slot_Downloading;
+		} else {
+			output.failed = true;
+			--output.activeChunks;
+			completeChunk(job, index);
+		}
+	}
+
+	if (output.failed && output.nextChunk < output.chunkCount) {
+		output.completedChunks += output.chunkCount - output.nextChunk - 1;
+		output.nextChunk = output.chunkCount;
+		completeChunk(job, index);
+	}
+	if (output.nextChunk == output.chunkCount &&
+		std::all_of(std::begin(output.slots), std::end(output.slots), [](const ExportSlot& slot) {
+			return slot.state == Slot_Idle;
+		})) {
+		release(context, output);
+	}
+}
+
+int Export::download(Context* context, ExportOutput& output, ExportSlot& slot) {
+	auto overlap = output.target.encoding == Encoding_Png && slot.chunk > 0 ? 1 : 0;
+	auto firstRow = slot.chunk * output.chunkRows - overlap;
+	slot.rows = std::min(output.chunkRows, output.readback.height - slot.chunk * output.chunkRows) + overlap;
+	if (slot.transferBuffer == nullptr) {
+		SDL_GPUTransferBufferCreateInfo transferBufferInfo {
+			.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD,
+			.size = 4 * (Uint32)output.readback.width * (Uint32)(std::min(output.chunkRows, output.readback.height) + 1)
+		};
+		slot.transferBuffer = SDL_CreateGPUTransferBuffer(context->device, &transferBufferInfo);
+		if (slot.transferBuffer == nullptr) {
+			SDL_Log("Create Export Transfer Buffer Failed.");
+			return -1;
+		}
+	}
+	return Image::downloadRows(context, output.readback, firstRow, slot.rows, slot.transferBuffer, slot.fence);
+}
+
+void Export::release(Context* context, ExportOutput& output) {
+	for (auto& slot : output.slots) {
+		if (slot.transferBuffer == nullptr) continue;
+		SDL_ReleaseGPUTransferBuffer(context->device, slot.transferBuffer);
+		slot.transferBuffer = nullptr;
+	}
+	if (output.readback.texture != nullptr) {
+		SDL_ReleaseGPUTexture(context->device, output.readback.texture);
+		output.readback.texture = nullptr;
+	}
+}
+
+SDL_Surface* Export::copyRows(const ExportOutput& output, const ExportSlot& slot) {
+	auto surface = SDL_CreateSurface(output.readback.width, slot.rows, SDL_PIXELFORMAT_ARGB8888);
+	if (surface == nullptr) return nullptr;
+	auto rowSize = (size_t)output.readback.width * 4;
+	for (auto y = 0; y < slot.rows; ++y) {
+		std::memcpy(static_cast<Uint8*>(surface->pixels) + (size_t)y * surface->pitch,
+			slot.mapped + (size_t)y * rowSize, rowSize);
+	}
+	return surface;
+}
+
+bool Export::encodeChunk(ExportOutput& output, int chunk, SDL_Surface*& surface) {
+	if (surface == nullptr) return false;
+	if (!output.streamed) {
+		output.surface = surface;
+		surface = nullptr;
+		return true;
+	}
+	auto png = output.target.encoding == Encoding_Png;
+	auto overlap = png && chunk > 0 ? 1 : 0;
+	if (png && Png::encodeRows(output.png, surface, overlap, chunk) != 0) return false;
+	return !output.jpegStream || Jpeg::encodeRows(output.jpeg, surface, overlap, chunk) == 0;
+}
+
+bool Export::encode(ExportOutput& output, int quality) {
+	const auto& target = output.target;
+	if (!output.streamed) {
+		auto partPath = target.path;
+		partPath += ".part";
+		return commitFile(partPath, target.path, IMG_SaveJPG(output.surface, partPath.string().c_str(), quality));
+	}
+	std::vector<Uint8> jpeg, data;
+	if (output.jpegStream) Jpeg::finish(output.jpeg, jpeg);
+	if (target.encoding == Encoding_Png) Png::finish(output.png, data);
+	if (!writeFile(target.path, target.encoding == Encoding_Png ? data : jpeg)) return false;
+	if (target.videoPath.empty()) return true;
+	if (Mp4::encode(jpeg, output.readback.width, output.readback.height, data) != 0) return false;
+	return writeFile(target.videoPath, data);
+}
+
+bool Export::writeFile(const std::filesystem::path& path, const std::vector<Uint8>& data) {
+	auto partPath = path;
+	partPath += ".part";
+	auto file = SDL_IOFromFile(partPath.string().c_str(), "wb");
+	if (file == nullptr) return false;
+	auto written = SDL_WriteIO(file, data.data(), data.size());
+	auto closed = SDL_CloseIO(file);
+	return commitFile(partPath, path, written == data.size() && closed);
+}
+
+bool Export::commitFile(const std::filesystem::path& partPath, const std::filesystem::path& path, bool written) {
+	std::error_code errorCode;
+	if (written) std::filesystem::rename(partPath, path, errorCode);
+	if (written && !errorCode) return true;
+	std::filesystem::remove(partPath, errorCode);
+	return false;
+}
+
+void Export::completeChunk(ExportJob& job, size_t index) {
+	auto& output = job.outputs[index];
+	if (++output.completedChunks < output.chunkCount) return;
+	writeQueue.push_back({ &job, index, -1, -1, nullptr });
+	writeSignal.notify_one();
+}
+
+void Export::finish(ExportJob& job, ExportOutput& output, bool error) {
+	auto elapsed = SDL_GetTicks() - job.queued;
+	auto& path = output.target.path;
+	if (error) SDL_Log("Export Failed: %s.", path.string().c_str());
+	else SDL_Log("Exported %s in %llums.", path.filename().string().c_str(), (unsigned long long)elapsed);
+	results.push_back(ExportResult{ job.id, output.target.format, path, job.displayName, error, elapsed });
+	output.done = true;
+	if (--job.remaining == 0) job.state = Export_Done;
+}
\ No newline at end of file
@@ -0,0 +1,169 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RENDEPTH_EXPORT_H
+#define RENDEPTH_EXPORT_H
+
+#include "Core.h"
+#include "Image.h"
+#include "Jpeg.h"
+#include "Png.h"
+#include "Render.h"
+#include <SDL3/SDL.h>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum ExportState {
+	Export_Active = 0,
+	Export_Done = 1
+};
+
+enum ExportEncoding {
+	Encoding_Jpeg = 0,
+	Encoding_Png = 1
+};
+
+enum ExportSlotState {
+	Slot_Idle = 0,
+	Slot_Downloading = 1,
+	Slot_Copying = 2,
+	Slot_Copied = 3
+};
+
+struct ExportPreset {
+	std::string name;
+	std::string format = "free_view";
+	ExportEncoding encoding = Encoding_Jpeg;
+	int quality = 90;
+	int width = 0;
+	int height = 0;
+	StereoParameters parameters{ 0.5f, 0.5f, 0.005f, false };
+	BackgroundStyle background = Dark;
+};
+
+struct ExportTarget {
+	StereoFormat format;
+	std::filesystem::path path;
+	ExportEncoding encoding;
+	std::filesystem::path videoPath;
+};
+
+struct ExportSlot {
+	int state;
+	int chunk;
+	int rows;
+	SDL_GPUTransferBuffer* transferBuffer;
+	SDL_GPUFence* fence;
+	Uint8* mapped;
+	SDL_Surface* surface;
+};
+
+struct ExportOutput {
+	ExportTarget target;
+	ExportReadback readback;
+	ExportSlot slots[2];
+	bool streamed;
+	bool jpegStream;
+	int chunkRows;
+	int chunkCount;
+	int nextChunk;
+	int activeChunks;
+	int completedChunks;
+	Jpeg::Stream jpeg;
+	Png::Stream png;
+	SDL_Surface* surface;
+	bool failed;
+	bool done;
+};
+
+struct ExportJob {
+	int id;
+	int state;
+	std::string displayName;
+	int quality;
+	std::vector<ExportOutput> outputs;
+	int remaining;
+	Uint64 queued;
+};
+
+struct ExportTask {
+	ExportJob* job;
+	size_t output;
+	int chunk;
+	int slot;
+	SDL_Surface* surface;
+};
+
+struct ExportResult {
+	int id;
+	StereoFormat format;
+	std::filesystem::path path;
+	std::string displayName;
+	bool error;
+	Uint64 elapsed;
+};
+
+class Export {
+public:
+	static int submit(Context* context, const std::vector<ExportTarget>& targets, const std::string& displayName,
+		const ExportPreset& preset);
+	static void update(Context* context);
+	static bool poll(ExportResult& result);
+	static int getPendingCount();
+	static void close(Context* context);
+	inline static int quality = 65;
+	inline static bool useStripedJpeg = true;
+	inline static int ioThreads = 0;
+	inline static int chunkRows = 256;
+	inline static int maxActiveChunks = 4;
+	inline static Uint32 closeDelay = 5;
+private:
+	static int start();
+	static int readRun(void* ptr);
+	static int writeRun(void* ptr);
+	static void prepare(ExportOutput& output, int quality);
+	static void updateOutput(Context* context, ExportJob& job, size_t index);
+	static int download(Context* context, ExportOutput& output, ExportSlot& slot);
+	static void release(Context* context, ExportOutput& output);
+	static SDL_Surface* copyRows(const ExportOutput& output, const ExportSlot& slot);
+	static bool encodeChunk(ExportOutput& output, int chunk, SDL_Surface*& surface);
+	static bool encode(ExportOutput& output, int quality);
+	static bool writeFile(const std::filesystem::path& path, const std::vector<Uint8>& data);
+	static bool commitFile(const std::filesystem::path& partPath, const std::filesystem::path& path, bool written);
+	static void completeChunk(ExportJob& job, size_t index);
+	static void finish(ExportJob& job, ExportOutput& output, bool error);
+	inline static std::mutex jobMutex;
+	inline static std::condition_variable readSignal;
+	inline static std::condition_variable writeSignal;
+	inline static std::list<ExportJob> jobs;
+	inline static std::deque<ExportTask> readQueue;
+	inline static std::deque<ExportTask> writeQueue;
+	inline static std::deque<ExportResult> results;
+	inline static std::vector<SDL_Thread*> threads;
+	inline static bool running = false;
+	inline static int nextJobId = 0;
+};
+
+#endif
\ No newline at end of file
@@ -20,6 +20,7 @@
 
 #include "Image.h"
 #include "Utils.h"
+#include "Cache.h"
 #include <iostream>
 
 glm::vec2 Image::getIconCoordinates(IconType iconType) {
@@ -123,6 +124,21 @@ int Image::load(Context* context, FileInfo& imageInfo, SDL_Surface* imageData) {
 	context->fileName = imageInfo.base;
 	imageInfo.type = Core::getImageType(imageInfo.path);
 	if (imageInfo.type == Unknown_Format) imageInfo.type = Core::defaultImportFormat;
+	if (imageInfo.type == Color_Plus_Depth && !imageInfo.cacheKey.empty()) {
+		Cache::storeSurface(imageInfo.cacheKey, imageData);
+		imageInfo.cacheKey.clear();
+	}
+	SDL_DestroySurface(colorSurface);
+	colorSurface = nullptr;
+	if (imageInfo.type == Color_Only && !imageInfo.depth.empty() && imageData->w * 2 <= maxImageSize) {
+		SDL_Surface* composed = Core::composeColorDepth(imageData, imageInfo.depth, imageInfo.depthSize);
+		if (composed != nullptr) {
+			colorSurface = imageData;
+			colorLink = imageInfo.link;
+			imageData = composed;
+			imageInfo.type = Color_Plus_Depth;
+		}
+	}
 	context->imageType = imageInfo.type;
 	context->imageSize = glm::vec2((float)imageData->w, (float)imageData->h);
 
@@ -150,7 +166,12 @@ int Image::load(Context* context, FileInfo& imageInfo, SDL_Surface* imageData) {
 	uploadTexture(context, imageData, &imageTexture, "Image Texture");
 	blitBlurTexture(context, imageTexture, (Uint32)imageData->w, (Uint32)imageData->h);
 	clearColorSolid = getBackgroundColor(imageData, 4, imageData->w, imageData->h);
-	SDL_DestroySurface(imageData);
+	if (imageInfo.type == Color_Only) {
+		colorSurface = imageData;
+		colorLink = imageInfo.link;
+	} else {
+		SDL_DestroySurface(imageData);
+	}
 
 	return 0;
 }
@@ -968,20 +989,109 @@ static SDL_GPUViewport getViewportGrid(glm::vec2 view, glm::vec2 rect) {
 	return result;
 }
 
-int Image::renderStereoImage(Context* context, StereoFormat stereoFormat) {
-	if (displayHelp) return -1;
-	if (context->imageType == Color_Only || context->imageType == Color_Anaglyph ||
+bool Image::canRenderStereo(Context* context, StereoFormat stereoFormat) {
+	if (displayHelp) return false;
+	return !(context->imageType == Color_Only || context->imageType == Color_Anaglyph ||
 		(context->imageType != Color_Plus_Depth &&
 		(stereoFormat == Color_Only || stereoFormat == Color_Plus_Depth ||
-			stereoFormat == Light_Field_LKG || stereoFormat == Light_Field_CV))) return -1;
+			stereoFormat == Light_Field_LKG || stereoFormat == Light_Field_CV)));
+}
+
+int Image::renderStereoImages(Context* context, const std::vector<StereoFormat>& stereoFormats,
+	std::vector<ExportReadback>& readbacks, const StereoParameters& parameters, BackgroundStyle background) {
+	readbacks.clear();
+	for (auto stereoFormat : stereoFormats) {
+		if (!canRenderStereo(context, stereoFormat)) return -1;
+	}
+
+	SDL_GPUCommandBuffer* commandBuffer = SDL_AcquireGPUCommandBuffer(context->device);
+	if (commandBuffer == nullptr) {
+		SDL_Log("Acquire GPU Command Buffer Failed.");
+		return -1;
+	}
+
+	for (auto stereoFormat : stereoFormats) {
+		ExportReadback readback{};
+		if (recordStereoImage(context, stereoFormat, commandBuffer, readback, parameters, background) != 0) {
+			SDL_CancelGPUCommandBuffer(commandBuffer);
+			releaseReadbacks(context, readbacks);
+			return -1;
+		}
+		readbacks.push_back(readback);
+	}
+
+	if (!SDL_SubmitGPUCommandBuffer(commandBuffer)) {
+		SDL_Log("Submit GPU Command Buffer Failed.");
+		releaseReadbacks(context, readbacks);
+		return -1;
+	}
+
+	return 0;
+}
+
+int Image::downloadRows(Context* context, const ExportReadback& readback, int y, int rows,
+	SDL_GPUTransferBuffer* transferBuffer, SDL_GPUFence*& fence) {
+	fence = nullptr;
+	SDL_GPUCommandBuffer* commandBuffer = SDL_AcquireGPUCommandBuffer(context->device);
+	if (commandBuffer == nullptr) {
+		SDL_Log("Acquire GPU Command Buffer Failed.");
+		return -1;
+	}
+
+	SDL_GPUCopyPass* copyPass = SDL_BeginGPUCopyPass(commandBuffer);
+
+	SDL_GPUTextureRegion textureRegion = {
+		.texture = readback.texture,
+		.mip_level = 0,
+		.layer = 0,
+		.x = 0,
+		.y = (Uint32)y,
+		.z = 0,
+		.w = (Uint32)readback.width,
+		.h = (Uint32)rows,
+		.d = 1
+	};
+
+	SDL_GPUTextureTransferInfo textureTransfer = {
+		.transfer_buffer = transferBuffer,
+		.offset = 0,
+		.pixels_per_row = (Uint32)readback.width,
+		.rows_per_layer = (Uint32)rows
+	};
+
+	SDL_DownloadFromGPUTexture(
+		copyPass, &textureRegion,
+		&textureTransfer
+	);
+
+	SDL_EndGPUCopyPass(copyPass);
+
+	fence = SDL_SubmitGPUCommandBufferAndAcquireFence(commandBuffer);
+	if (fence == nullptr) {
+		SDL_Log("Submit GPU Command Buffer Failed.");
+		return -1;
+	}
+
+	return 0;
+}
+
+void Image::releaseReadbacks(Context* context, std::vector<ExportReadback>& readbacks) {
+	for (auto& readback : readbacks) {
+		if (readback.texture != nullptr) SDL_ReleaseGPUTexture(context->device, readback.texture);
+	}
+	readbacks.clear();
+}
+
+int Image::recordStereoImage(Context* context, StereoFormat stereoFormat, SDL_GPUCommandBuffer* commandBuffer,
+	ExportReadback& readback, const StereoParameters& parameters, BackgroundStyle background) {
 
 	auto renderFormat = Left;
 	auto singleImageSize = context->imageSize;
 	auto viewportSize = singleImageSize;
 	auto viewsX = 1, viewsY = 1;
-	auto stereoStrength = context->stereoStrength;
-	auto stereoDepth = context->stereoDepth;
-	auto stereoOffset = context->stereoOffset;
+	auto stereoStrength = (double)parameters.strength;
+	auto stereoDepth = (double)parameters.depth;
+	auto stereoOffset = (double)parameters.offset;
 	auto gridBoost = 8.0;
 	auto strengthStep = 0.0;
 	auto offsetStep = 0.0;
@@ -1064,8 +1174,11 @@ int Image::renderStereoImage(Context* context, StereoFormat stereoFormat) {
 		.num_levels = 1
 	};
 
-	if (exportTexture != nullptr) SDL_ReleaseGPUTexture(context->device, exportTexture);
-	exportTexture = SDL_CreateGPUTexture(context->device, &textureCreateInfo);
+	SDL_GPUTexture* exportTexture = SDL_CreateGPUTexture(context->device, &textureCreateInfo);
+	if (exportTexture == nullptr) {
+		SDL_Log("Create Export Texture Failed.");
+		return -1;
+	}
 
 	SDL_SetGPUTextureName(
 		context->device,
@@ -1073,15 +1186,9 @@ int Image::renderStereoImage(Context* context, StereoFormat stereoFormat) {
 		"Export Texture"
 	);
 
-	SDL_GPUCommandBuffer* commandBuffer = SDL_AcquireGPUCommandBuffer(context->device);
-	if (commandBuffer == nullptr) {
-		SDL_Log("Acquire GPU Command Buffer Failed.");
-		return -1;
-	}
-
-	if (context->backgroundStyle == Solid) clearColorCurrent = clearColorSolid;
-	else if (context->backgroundStyle == Light) clearColorCurrent = clearColorLight;
-	else if (context->backgroundStyle == Dark) clearColorCurrent = clearColorDark;
+	if (background == Solid) clearColorCurrent = clearColorSolid;
+	else if (background == Light) clearColorCurrent = clearColorLight;
+	else if (background == Dark) clearColorCurrent = clearColorDark;
 
 	SDL_GPUColorTargetInfo colorTargetInfo = {};
 	colorTargetInfo.texture = exportTexture;
@@ -1110,6 +1217,7 @@ int Image::renderStereoImage(Context* context, StereoFormat stereoFormat) {
 				renderFormat = (ViewMode)(Left + (renderX + (renderY % 2)) % 2);
 			}
 			imageDataFrag.mode = renderFormat;
+			imageDataFrag.swapLeftRight = (int)parameters.swapLeftRight;
 			imageDataFrag.stereoStrength = (float)stereoStrength;
 			imageDataFrag.stereoDepth = (float)stereoDepth;
 			imageDataFrag.stereoOffset = (float)stereoOffset;
@@ -1135,100 +1243,13 @@ int Image::renderStereoImage(Context* context, StereoFormat stereoFormat) {
 
 	SDL_EndGPURenderPass(renderPass);
 
-	SDL_GPUFence* fence = SDL_SubmitGPUCommandBufferAndAcquireFence(commandBuffer);
-	SDL_WaitForGPUFences(context->device, true, &fence, 1);
-	SDL_ReleaseGPUFence(context->device, fence);
+	readback.texture = exportTexture;
+	readback.width = (int)viewportSize.x;
+	readback.height = (int)viewportSize.y;
 
 	return 0;
 }
 
-SDL_Surface* Image::getExportTexture(Context* context, StereoFormat stereoFormat) {
-	SDL_GPUCommandBuffer* commandBuffer = SDL_AcquireGPUCommandBuffer(context->device);
-	SDL_GPUCopyPass* copyPass = SDL_BeginGPUCopyPass(commandBuffer);
-
-	auto stereoImageSize = context->imageSize;
-
-	if (stereoFormat == Color_Anaglyph) {
-		stereoImageSize = context->imageSize;
-	} else if (stereoFormat == Side_By_Side_Full) {
-		stereoImageSize = context->imageSize * glm::vec2(2.0, 1.0);
-	} else if (stereoFormat == Side_By_Side_Half) {
-		stereoImageSize = context->imageSize;
-	} else if (stereoFormat == Color_Plus_Depth) {
-		stereoImageSize = context->imageSize * glm::vec2(2.0, 1.0);
-	} else if (stereoFormat == Stereo_Free_View_Grid) {
-		stereoImageSize = context->imageSize;
-	} else if (stereoFormat == Stereo_Free_View_LRL) {
-		stereoImageSize = context->imageSize * glm::vec2(1.5, 0.5);
-	} else if (stereoFormat == Light_Field_LKG) {
-		auto maxRes = exportQuiltMaxResLKG;
-		auto maxSize = std::max(stereoImageSize.x, stereoImageSize.y);
-		stereoImageSize *= maxRes / maxSize;
-		stereoImageSize.x = roundf(stereoImageSize.x);
-		stereoImageSize.y = roundf(stereoImageSize.y);
-		stereoImageSize = stereoImageSize * exportQuiltDimLKG;
-	} else if (stereoFormat == Light_Field_CV) {
-		auto maxRes = exportQuiltMaxResCV;
-		auto maxSize = std::max(stereoImageSize.x, stereoImageSize.y);
-		stereoImageSize *= maxRes / maxSize;
-		stereoImageSize.x = roundf(stereoImageSize.x);
-		stereoImageSize.y = roundf(stereoImageSize.y);
-		stereoImageSize = stereoImageSize * exportQuiltDimCV;
-	}
-
-	SDL_GPUTransferBufferCreateInfo transferBufferInfo {
-		.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD,
-		.size = 4 * (Uint32)stereoImageSize.x * (Uint32)stereoImageSize.y
-	};
-
-	SDL_GPUTransferBuffer* downloadTransferBuffer = SDL_CreateGPUTransferBuffer(
-		context->device, &transferBufferInfo);
-
-	SDL_GPUTextureRegion textureRegion = {
-		.texture = exportTexture,
-		.mip_level = 0,
-		.layer = 0,
-		.x = 0,
-		.y = 0,
-		.z = 0,
-		.w = (Uint32)stereoImageSize.x,
-		.h = (Uint32)stereoImageSize.y,
-		.d = 1
-	};
-
-	SDL_GPUTextureTransferInfo textureTransfer = {
-		.transfer_buffer = downloadTransferBuffer,
-		.offset = 0,
-		.pixels_per_row = (Uint32)stereoImageSize.x,
-		.rows_per_layer = (Uint32)stereoImageSize.y
-	};
-
-	SDL_DownloadFromGPUTexture(
-		copyPass, &textureRegion,
-		&textureTransfer
-	);
-
-	SDL_EndGPUCopyPass(copyPass);
-
-	SDL_GPUFence* fence = SDL_SubmitGPUCommandBufferAndAcquireFence(commandBuffer);
-	SDL_WaitForGPUFences(context->device, true, &fence, 1);
-	SDL_ReleaseGPUFence(context->device, fence);
-
-	auto downloadedData = (Uint8*)SDL_MapGPUTransferBuffer(
-		context->device,
-		downloadTransferBuffer,
-		false
-	);
-
-	auto result = SDL_CreateSurfaceFrom((int)stereoImageSize.x, (int)stereoImageSize.y,
-		SDL_PIXELFORMAT_ARGB8888, downloadedData, (int)stereoImageSize.x * 4);
-
-	SDL_UnmapGPUTransferBuffer(context->device, downloadTransferBuffer);
-	SDL_ReleaseGPUTransferBuffer(context->device, downloadTransferBuffer);
-
-	return result;
-}
-
 void Image::bindPipeline(SDL_GPURenderPass* renderPass, SDL_GPUGraphicsPipeline* pipeline) {
 	SDL_GPUBufferBinding bindingVertex = { .buffer = sharedVertexBuffer, .offset = 0 };
 	SDL_GPUBufferBinding bindingIndex = { .buffer = sharedIndexBuffer, .offset = 0 };
@@ -1544,7 +1565,7 @@ int Image::draw(Context* context) {
 					menuSampleBindings[0] = { .texture = menuTexture, .sampler = imageSampler };
 					SDL_BindGPUFragmentSamplers(renderPass, 0, &menuSampleBindings[0], 1);
 
-					spriteColor = viewColorWhiteSolid;
+					spriteColor = choice.disabled ? viewColorGrayLight : viewColorWhiteSolid;
 					auto menuTextVis = 1.0f;
 					if (context->mode == RGB_Depth && view > 0) menuTextVis = 0.0f;
 					setSpriteUniforms(choice.layout.position + menuMargin, choice.layout.size, spriteColor,
@@ -1556,8 +1577,8 @@ int Image::draw(Context* context) {
 					for (const auto& option : choice.options) {
 						uvOffset = optionTextures[option].offset / menuTextureSize;
 						uvSize = optionTextures[option].size / menuTextureSize;
-						auto selection = (*context->menuSelection)[choice.label] == optionIndex;
-						auto rollover = (*context->menuRollover)[choice.label] == optionIndex;
+						auto selection = !choice.disabled && (*context->menuSelection)[choice.label] == optionIndex;
+						auto rollover = !choice.disabled && (*context->menuRollover)[choice.label] == optionIndex;
 
 						if (selection || (context->mode == RGB_Depth && view > 0)) {
 							menuSampleBindings[0] = { .texture = sliderTexture, .sampler = imageSampler };
@@ -1577,6 +1598,7 @@ int Image::draw(Context* context) {
 						SDL_BindGPUFragmentSamplers(renderPass, 0, &menuSampleBindings[0], 1);
 
 						spriteColor = rollover && !selection ? viewColorPinkSolid : viewColorWhiteSolid;
+						if (choice.disabled) spriteColor = viewColorGrayLight;
 						auto menuTextVis = 1.0f;
 						if (context->mode == RGB_Depth && view > 0) menuTextVis = 0.0f;
 						setSpriteUniforms(choice.layouts[optionIndex].position + menuMargin,
@@ -1709,10 +1731,10 @@ void Image::quit(Context* context){
 	SDL_ReleaseGPUTexture(context->device, helpTexture);
 	SDL_ReleaseGPUTexture(context->device, menuTexture);
 	SDL_ReleaseGPUTexture(context->device, sliderTexture);
-	SDL_ReleaseGPUTexture(context->device, exportTexture);
 	SDL_ReleaseGPUSampler(context->device, imageSampler);
 	SDL_DestroySurface(menuTextSurface);
 	SDL_DestroySurface(ssimSurface);
+	SDL_DestroySurface(colorSurface);
 	TTF_CloseFont(menuFont);
 	TTF_CloseFont(helpFont);
 	TTF_Quit();
@@ -22,6 +22,7 @@
 #define RENDEPTH_IMAGE_H
 
 #include "Core.h"
+#include "Render.h"
 #include "Utils.h"
 #include "Style.h"
 #define GLM_ENABLE_EXPERIMENTAL
@@ -30,6 +31,12 @@
 #include "SDL3_shadercross/SDL_shadercross.h"
 #include <filesystem>
 
+struct ExportReadback {
+	SDL_GPUTexture* texture;
+	int width;
+	int height;
+};
+
 class Image {
 public:
 	Image() = default;
@@ -48,10 +55,11 @@ public:
 	inline static SDL_GPUTexture* infoTexture = nullptr;
 	inline static SDL_GPUTexture* menuTexture = nullptr;
 	inline static SDL_GPUTexture* sliderTexture = nullptr;
-	inline static SDL_GPUTexture* exportTexture = nullptr;
 	inline static SDL_GPUSampler* imageSampler = nullptr;
 	inline static SDL_Surface* menuTextSurface = nullptr;
 	inline static SDL_Surface* ssimSurface = nullptr;
+	inline static SDL_Surface* colorSurface = nullptr;
+	inline static std::string colorLink;
 	inline static TTF_Font* helpFont = nullptr;
 	inline static TTF_Font* infoFont = nullptr;
 	inline static TTF_Font* menuFont = nullptr;
@@ -154,8 +162,14 @@ public:
 	static int uploadTexture(Context* context, SDL_Surface* imageData, SDL_GPUTexture** gpuTexture,
 			const std::string& textureName);
 	static void blitBlurTexture(Context* context, SDL_GPUTexture *inputTexture, Uint32 imageWidth, Uint32 imageHeight);
-	static int renderStereoImage(Context* context, StereoFormat stereoFormat);
-	static SDL_Surface* getExportTexture(Context* context, StereoFormat stereoFormat);
+	static bool canRenderStereo(Context* context, StereoFormat stereoFormat);
+	static int renderStereoImages(Context* context, const std::vector<StereoFormat>& stereoFormats,
+		std::vector<ExportReadback>& readbacks, const StereoParameters& parameters, BackgroundStyle background);
+	static int downloadRows(Context* context, const ExportReadback& readback, int y, int rows,
+		SDL_GPUTransferBuffer* transferBuffer, SDL_GPUFence*& fence);
+	static int recordStereoImage(Context* context, StereoFormat stereoFormat, SDL_GPUCommandBuffer* commandBuffer,
+		ExportReadback& readback, const StereoParameters& parameters, BackgroundStyle background);
+	static void releaseReadbacks(Context* context, std::vector<ExportReadback>& readbacks);
 	static glm::vec2 getIconCoordinates(IconType iconType);
 	static glm::vec2 updateRatio(Context* context, glm::vec2 windowSize);
 	static void updateSize(Context* context);
@@ -0,0 +1,368 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Jpeg.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+static const Uint8 zigzag[64] = {
+	0, 1, 5, 6, 14, 15, 27, 28, 2, 4, 7, 13, 16, 26, 29, 42,
+	3, 8, 12, 17, 25, 30, 41, 43, 9, 11, 18, 24, 31, 40, 44, 53,
+	10, 19, 23, 32, 39, 45, 52, 54, 20, 22, 33, 38, 46, 51, 55, 60,
+	21, 34, 37, 47, 50, 56, 59, 61, 35, 36, 48, 49, 57, 58, 62, 63 };
+
+static const Uint8 lumaBase[64] = {
+	16, 11, 10, 16, 24, 40, 51, 61, 12, 12, 14, 19, 26, 58, 60, 55,
+	14, 13, 16, 24, 40, 57, 69, 56, 14, 17, 22, 29, 51, 87, 80, 62,
+	18, 22, 37, 56, 68, 109, 103, 77, 24, 35, 55, 64, 81, 104, 113, 92,
+	49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99 };
+
+static const Uint8 chromaBase[64] = {
+	17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99,
+	24, 26, 56, 99, 99, 99, 99, 99, 47, 66, 99, 99, 99, 99, 99, 99,
+	99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99,
+	99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99 };
+
+static const float dctScale[8] = {
+	1.0f, 1.387039845f, 1.306562965f, 1.175875602f, 1.0f, 0.785694958f, 0.541196100f, 0.275899379f };
+
+static const Uint8 dcLumaCounts[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+static const Uint8 dcChromaCounts[16] = { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+static const Uint8 dcValues[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+static const Uint8 acLumaCounts[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d };
+static const Uint8 acLumaValues[162] = {
+	0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+	0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+	0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+	0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+	0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+	0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+	0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+	0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+	0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+	0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+	0xf9, 0xfa };
+
+static const Uint8 acChromaCounts[16] = { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+static const Uint8 acChromaValues[162] = {
+	0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+	0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+	0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+	0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+	0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+	0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+	0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+	0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+	0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+	0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+	0xf9, 0xfa };
+
+static void writeMarker(std::vector<Uint8>& output, Uint8 marker, int length) {
+	output.insert(output.end(), { 0xFF, marker, (Uint8)(length >> 8), (Uint8)(length & 0xFF) });
+}
+
+void Jpeg::BitWriter::write(Uint32 bits, int size) {
+	buffer = (buffer << size) | (bits & ((1u << size) - 1));
+	count += size;
+	while (count >= 8) {
+		count -= 8;
+		auto byte = (Uint8)(buffer >> count);
+		data.push_back(byte);
+		if (byte == 0xFF) data.push_back(0);
+	}
+}
+
+void Jpeg::BitWriter::flush() {
+	if (count > 0) write((1u << (8 - count)) - 1, 8 - count);
+}
+
+void Jpeg::buildTables(int quality, Tables& tables) {
+	quality = std::clamp(quality, 1, 100);
+	auto factor = quality < 50 ? 5000 / quality : 200 - quality * 2;
+	for (auto i = 0; i < 64; ++i) {
+		tables.luma[i] = (Uint8)std::clamp((lumaBase[i] * factor + 50) / 100, 1, 255);
+		tables.chroma[i] = (Uint8)std::clamp((chromaBase[i] * factor + 50) / 100, 1, 255);
+		auto scale = dctScale[i / 8] * dctScale[i % 8] * 8.0f;
+		tables.lumaScale[i] = 1.0f / (tables.luma[i] * scale);
+		tables.chromaScale[i] = 1.0f / (tables.chroma[i] * scale);
+	}
+	buildHuffman(dcLumaCounts, dcValues, tables.dcLuma);
+	buildHuffman(acLumaCounts, acLumaValues, tables.acLuma);
+	buildHuffman(dcChromaCounts, dcValues, tables.dcChroma);
+	buildHuffman(acChromaCounts, acChromaValues, tables.acChroma);
+}
+
+void Jpeg::buildHuffman(const Uint8* counts, const Uint8* values, HuffmanTable& table) {
+	Uint16 code = 0;
+	auto index = 0;
+	for (auto length = 1; length <= 16; ++length) {
+		for (auto i = 0; i < counts[length - 1]; ++i, ++index) {
+			table.codes[values[index]] = code++;
+			table.sizes[values[index]] = (Uint8)length;
+		}
+		code <<= 1;
+	}
+}
+
+void Jpeg::forwardDct(float* block) {
+	for (auto pass = 0; pass < 2; ++pass) {
+		auto step = pass == 0 ? 1 : 8;
+		auto stride = pass == 0 ? 8 : 1;
+		for (auto line = 0; line < 8; ++line) {
+			auto data = block + line * stride;
+			auto tmp0 = data[0] + data[step * 7], tmp7 = data[0] - data[step * 7];
+			auto tmp1 = data[step] + data[step * 6], tmp6 = data[step] - data[step * 6];
+			auto tmp2 = data[step * 2] + data[step * 5], tmp5 = data[step * 2] - data[step * 5];
+			auto tmp3 = data[step * 3] + data[step * 4], tmp4 = data[step * 3] - data[step * 4];
+
+			auto tmp10 = tmp0 + tmp3, tmp13 = tmp0 - tmp3;
+			auto tmp11 = tmp1 + tmp2, tmp12 = tmp1 - tmp2;
+			data[0] = tmp10 + tmp11;
+			data[step * 4] = tmp10 - tmp11;
+			auto z1 = (tmp12 + tmp13) * 0.707106781f;
+			data[step * 2] = tmp13 + z1;
+			data[step * 6] = tmp13 - z1;
+
+			tmp10 = tmp4 + tmp5;
+			tmp11 = tmp5 + tmp6;
+			tmp12 = tmp6 + tmp7;
+			auto z5 = (tmp10 - tmp12) * 0.382683433f;
+			auto z2 = tmp10 * 0.541196100f + z5;
+			auto z4 = tmp12 * 1.306562965f + z5;
+			auto z3 = tmp11 * 0.707106781f;
+			auto z11 = tmp7 + z3, z13 = tmp7 - z3;
+			data[step * 5] = z13 + z2;
+			data[step * 3] = z13 - z2;
+			data[step] = z11 + z4;
+			data[step * 7] = z11 - z4;
+		}
+	}
+}
+
+static int getBitLength(int value) {
+	auto magnitude = (Uint32)std::abs(value);
+	auto length = 0;
+	while (magnitude) {
+		++length;
+		magnitude >>= 1;
+	}
+	return length;
+}
+
+int Jpeg::encodeBlock(BitWriter& writer, float* block, const float* scale, int previousDc,
+	const HuffmanTable& dc, const HuffmanTable& ac) {
+	forwardDct(block);
+	int coefficients[64];
+	for (auto i = 0; i < 64; ++i) coefficients[zigzag[i]] = (int)std::lround(block[i] * scale[i]);
+
+	auto difference = coefficients[0] - previousDc;
+	auto length = getBitLength(difference);
+	writer.write(dc.codes[length], dc.sizes[length]);
+	if (length > 0) writer.write(difference < 0 ? difference - 1 : difference, length);
+
+	auto last = 63;
+	while (last > 0 && coefficients[last] == 0) --last;
+	auto run = 0;
+	for (auto i = 1; i <= last; ++i) {
+		if (coefficients[i] == 0) {
+			++run;
+			continue;
+		}
+		while (run >= 16) {
+			writer.write(ac.codes[0xF0], ac.sizes[0xF0]);
+			run -= 16;
+		}
+		length = getBitLength(coefficients[i]);
+		auto symbol = run << 4 | length;
+		writer.write(ac.codes[symbol], ac.sizes[symbol]);
+		writer.write(coefficients[i] < 0 ? coefficients[i] - 1 : coefficients[i], length);
+		run = 0;
+	}
+	if (last < 63) writer.write(ac.codes[0x00], ac.sizes[0x00]);
+	return coefficients[0];
+}
+
+void Jpeg::encodeStripe(const Uint8* pixels, int pitch, int width, int height, const int channels[3],
+	const Tables& tables, BitWriter& writer) {
+	auto mcuColumns = (width + 15) / 16;
+	auto mcuRows = (height + 15) / 16;
+	float luma[4][64], blue[64], red[64];
+	int lumaDc = 0, blueDc = 0, redDc = 0;
+	for (auto mcuRow = 0; mcuRow < mcuRows; ++mcuRow) {
+		for (auto mcuColumn = 0; mcuColumn < mcuColumns; ++mcuColumn) {
+			std::fill(std::begin(blue), std::end(blue), 0.0f);
+			std::fill(std::begin(red), std::end(red), 0.0f);
+			for (auto y = 0; y < 16; ++y) {
+				auto sourceY = std::min(mcuRow * 16 + y, height - 1);
+				auto row = pixels + (size_t)sourceY * pitch;
+				for (auto x = 0; x < 16; ++x) {
+					auto source = row + (size_t)std::min(mcuColumn * 16 + x, width - 1) * 4;
+					auto r = (float)source[channels[0]];
+					auto g = (float)source[channels[1]];
+					auto b = (float)source[channels[2]];
+					luma[(y / 8) * 2 + x / 8][(y % 8) * 8 + x % 8] = 0.299f * r + 0.587f * g + 0.114f * b - 128.0f;
+					auto chroma = (y / 2) * 8 + x / 2;
+					blue[chroma] += (-0.168736f * r - 0.331264f * g + 0.5f * b) * 0.25f;
+					red[chroma] += (0.5f * r - 0.418688f * g - 0.081312f * b) * 0.25f;
+				}
+			}
+			for (auto& block : luma)
+				lumaDc = encodeBlock(writer, block, tables.lumaScale, lumaDc, tables.dcLuma, tables.acLuma);
+			blueDc = encodeBlock(writer, blue, tables.chromaScale, blueDc, tables.dcChroma, tables.acChroma);
+			redDc = encodeBlock(writer, red, tables.chromaScale, redDc, tables.dcChroma, tables.acChroma);
+		}
+	}
+	writer.flush();
+}
+
+void Jpeg::writeHeader(std::vector<Uint8>& output, int width, int height, const Tables& tables,
+	int restartInterval) {
+	output.insert(output.end(), { 0xFF, 0xD8 });
+	writeMarker(output, 0xE0, 16);
+	output.insert(output.end(), { 'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0 });
+
+	writeMarker(output, 0xDB, 2 + 65 * 2);
+	for (auto table = 0; table < 2; ++table) {
+		output.push_back((Uint8)table);
+		Uint8 ordered[64];
+		for (auto i = 0; i < 64; ++i) ordered[zigzag[i]] = table == 0 ? tables.luma[i] : tables.chroma[i];
+		output.insert(output.end(), ordered, ordered + 64);
+	}
+
+	writeMarker(output, 0xC0, 17);
+	output.insert(output.end(), { 8, (Uint8)(height >> 8), (Uint8)(height & 0xFF),
+		(Uint8)(width >> 8), (Uint8)(width & 0xFF), 3, 1, 0x22, 0, 2, 0x11, 1, 3, 0x11, 1 });
+
+	writeMarker(output, 0xC4, 2 + 17 * 4 + 12 * 2 + 162 * 2);
+	const Uint8* counts[4] = { dcLumaCounts, acLumaCounts, dcChromaCounts, acChromaCounts };
+	const Uint8* values[4] = { dcValues, acLumaValues, dcValues, acChromaValues };
+	const Uint8 classes[4] = { 0x00, 0x10, 0x01, 0x11 };
+	for (auto i = 0; i < 4; ++i) {
+		output.push_back(classes[i]);
+		output.insert(output.end(), counts[i], counts[i] + 16);
+		output.insert(output.end(), values[i], values[i] + ((classes[i] & 0x10) ? 162 : 12));
+	}
+
+	if (restartInterval > 0) {
+		writeMarker(output, 0xDD, 4);
+		output.insert(output.end(), { (Uint8)(restartInterval >> 8), (Uint8)(restartInterval & 0xFF) });
+	}
+
+	writeMarker(output, 0xDA, 12);
+	output.insert(output.end(), { 3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 63, 0 });
+}
+
+int Jpeg::getStripeRows(int width, int rows) {
+	auto mcuColumns = std::max((width + 15) / 16, 1);
+	return std::clamp((rows + 15) / 16, 1, std::max(65535 / mcuColumns, 1)) * 16;
+}
+
+int Jpeg::begin(Stream& stream, int width, int height, int quality, int stripeRows) {
+	if (width <= 0 || height <= 0 || width > 65535 || height > 65535 || stripeRows <= 0 || stripeRows % 16 != 0 ||
+		(width + 15) / 16 * (stripeRows / 16) > 65535) return -1;
+	buildTables(quality, stream.tables);
+	stream.width = width;
+	stream.height = height;
+	stream.stripeRows = stripeRows;
+	stream.stripes.assign((height + stripeRows - 1) / stripeRows, {});
+	return 0;
+}
+
+int Jpeg::encodeRows(Stream& stream, const SDL_Surface* surface, int firstRow, int stripe) {
+	if (surface == nullptr || surface->w != stream.width || stripe < 0 || stripe >= (int)stream.stripes.size())
+		return -1;
+	auto rows = std::min(stream.stripeRows, stream.height - stripe * stream.stripeRows);
+	if (firstRow < 0 || firstRow + rows > surface->h) return -1;
+	auto source = surface;
+	SDL_Surface* converted = nullptr;
+	int channels[3] = { 0, 1, 2 };
+	if (surface->format == SDL_PIXELFORMAT_BGRA32 || surface->format == SDL_PIXELFORMAT_BGRX32) {
+		channels[0] = 2;
+		channels[2] = 0;
+	} else if (surface->format != SDL_PIXELFORMAT_RGBA32 && surface->format != SDL_PIXELFORMAT_RGBX32) {
+		converted = SDL_ConvertSurface(const_cast<SDL_Surface*>(surface), SDL_PIXELFORMAT_RGBA32);
+		if (converted == nullptr) return -1;
+		source = converted;
+	}
+
+	BitWriter writer;
+	writer.data.reserve((size_t)stream.width * rows / 4);
+	encodeStripe(static_cast<const Uint8*>(source->pixels) + (size_t)firstRow * source->pitch, source->pitch,
+		stream.width, rows, channels, stream.tables, writer);
+	stream.stripes[stripe] = std::move(writer.data);
+	SDL_DestroySurface(converted);
+	return 0;
+}
+
+void Jpeg::finish(Stream& stream, std::vector<Uint8>& output) {
+	auto stripeCount = (int)stream.stripes.size();
+	size_t dataSize = 0;
+	for (const auto& stripe : stream.stripes) dataSize += stripe.size() + 2;
+	output.clear();
+	output.reserve(dataSize + 1024);
+	writeHeader(output, stream.width, stream.height, stream.tables,
+		stripeCount > 1 ? (stream.width + 15) / 16 * (stream.stripeRows / 16) : 0);
+	for (auto i = 0; i < stripeCount; ++i) {
+		if (i > 0) output.insert(output.end(), { 0xFF, (Uint8)(0xD0 + (i - 1) % 8) });
+		output.insert(output.end(), stream.stripes[i].begin(), stream.stripes[i].end());
+		std::vector<Uint8>().swap(stream.stripes[i]);
+	}
+	output.insert(output.end(), { 0xFF, 0xD9 });
+}
+
+int Jpeg::encode(const SDL_Surface* surface, int quality, std::vector<Uint8>& output) {
+	if (surface == nullptr) return -1;
+	auto mcuRows = (surface->h + 15) / 16;
+	auto threadCount = encodeThreads > 0 ? encodeThreads : (int)std::thread::hardware_concurrency();
+	threadCount = std::clamp(threadCount, 1, std::max(mcuRows, 1));
+	auto rowsPerStripe = stripeRows > 0 ? stripeRows :
+		(mcuRows + threadCount * stripesPerThread - 1) / (threadCount * stripesPerThread) * 16;
+	Stream stream{};
+	if (begin(stream, surface->w, surface->h, quality, getStripeRows(surface->w, rowsPerStripe)) != 0) return -1;
+
+	auto stripeCount = (int)stream.stripes.size();
+	std::atomic<int> nextStripe = 0;
+	std::atomic<bool> failed = false;
+	auto work = [&]() {
+		for (auto stripe = nextStripe++; stripe < stripeCount; stripe = nextStripe++) {
+			if (encodeRows(stream, surface, stripe * stream.stripeRows, stripe) != 0) failed = true;
+		}
+	};
+	std::vector<std::thread> threads;
+	for (auto i = 1; i < std::min(threadCount, stripeCount); ++i) threads.emplace_back(work);
+	work();
+	for (auto& thread : threads) thread.join();
+	if (failed) return -1;
+	finish(stream, output);
+	return 0;
+}
+
+int Jpeg::save(const SDL_Surface* surface, const std::filesystem::path& path, int quality) {
+	std::vector<Uint8> output;
+	if (encode(surface, quality, output) != 0) return -1;
+	auto file = SDL_IOFromFile(path.string().c_str(), "wb");
+	if (file == nullptr) return -1;
+	auto written = SDL_WriteIO(file, output.data(), output.size());
+	auto closed = SDL_CloseIO(file);
+	return written == output.size() && closed ? 0 : -1;
+}
\ No newline at end of file
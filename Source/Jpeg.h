@@ -0,0 +1,83 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RENDEPTH_JPEG_H
+#define RENDEPTH_JPEG_H
+
+#include <SDL3/SDL.h>
+#include <filesystem>
+#include <vector>
+
+class Jpeg {
+public:
+	struct HuffmanTable {
+		Uint16 codes[256];
+		Uint8 sizes[256];
+	};
+
+	struct Tables {
+		Uint8 luma[64];
+		Uint8 chroma[64];
+		float lumaScale[64];
+		float chromaScale[64];
+		HuffmanTable dcLuma;
+		HuffmanTable acLuma;
+		HuffmanTable dcChroma;
+		HuffmanTable acChroma;
+	};
+
+	struct Stream {
+		Tables tables;
+		int width;
+		int height;
+		int stripeRows;
+		std::vector<std::vector<Uint8>> stripes;
+	};
+
+	static int encode(const SDL_Surface* surface, int quality, std::vector<Uint8>& output);
+	static int save(const SDL_Surface* surface, const std::filesystem::path& path, int quality);
+	static int getStripeRows(int width, int rows);
+	static int begin(Stream& stream, int width, int height, int quality, int stripeRows);
+	static int encodeRows(Stream& stream, const SDL_Surface* surface, int firstRow, int stripe);
+	static void finish(Stream& stream, std::vector<Uint8>& output);
+	inline static int encodeThreads = 0;
+	inline static int stripeRows = 0;
+	inline static int stripesPerThread = 4;
+private:
+	struct BitWriter {
+		std::vector<Uint8> data;
+		Uint32 buffer = 0;
+		int count = 0;
+		void write(Uint32 bits, int size);
+		void flush();
+	};
+
+	static void buildTables(int quality, Tables& tables);
+	static void buildHuffman(const Uint8* counts, const Uint8* values, HuffmanTable& table);
+	static void forwardDct(float* block);
+	static int encodeBlock(BitWriter& writer, float* block, const float* scale, int previousDc,
+		const HuffmanTable& dc, const HuffmanTable& ac);
+	static void encodeStripe(const Uint8* pixels, int pitch, int width, int height, const int channels[3],
+		const Tables& tables, BitWriter& writer);
+	static void writeHeader(std::vector<Uint8>& output, int width, int height, const Tables& tables,
+		int restartInterval);
+};
+
+#endif
\ No newline at end of file
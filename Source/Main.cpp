@@ -33,7 +33,6 @@
 #include "rapidjson/writer.h"
 #include "rapidjson/prettywriter.h"
 #include "rapidjson/stringbuffer.h"
-#include <zmq.hpp>
 #include <filesystem>
 #include <format>
 #include <algorithm>
@@ -45,9 +44,9 @@
 #include <chrono>
 #include <atomic>
 #include <cstdlib>
-#include <regex>
 #include <thread>
 #include <random>
+#include <sstream>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -56,15 +55,34 @@
 #include "Core.h"
 #include "Utils.h"
 #include "Image.h"
+#include "Service.h"
+#include "Process.h"
+#include "Cache.h"
+#include "Depth.h"
+#include "Export.h"
+#include "Clip.h"
+#include "Render.h"
+#include "Png.h"
+#include "Preset.h"
+#include "Server.h"
 
 Context context{};
 Image imageView{};
 
 glm::vec2 windowSize{};
 auto switchedImage = false;
+auto depthSwapPending = false;
 auto isFullscreen = false;
 auto isMaximized = false;
 auto quitAppNextFrame = false;
+std::vector<StereoFormat> exportRequest{};
+auto exportDepthRequested = false;
+auto quitAfterExport = false;
+auto zoomExport = false;
+std::vector<ViewMode> displayRequest{};
+std::string serveEndpoint{};
+std::vector<std::string> presetPaths{};
+std::vector<ExportPreset> exportPresets{};
 auto currentVisibility = 1.0;
 auto targetVisibility = 1.0;
 auto currentZoom = 1.0;
@@ -92,17 +110,17 @@ bool isIconCaptured = false;
 const auto mouseDelayCount = 1;
 auto mouseMoveDelay = mouseDelayCount;
 auto mouseValueNull = -128.0f;
-static std::string depthCommand;
 bool isConverting = false;
 bool justConverted = false;
 SDL_Thread* depthGenThread = nullptr;
-SDL_Thread* depthPipeThread = nullptr;
 std::atomic<bool> depthGenAlive (false);
-std::atomic<bool> depthPipeAlive (false);
+std::atomic<bool> batchRunning (false);
+std::filesystem::path batchManifestPath;
+std::string batchProgressText;
+auto batchProgressTime = 0.0;
+auto batchProgressWait = 1.0;
 std::atomic<bool> doneLoadingImage (false);
-std::atomic<bool> depthPipeError (false);
 std::atomic<bool> doingFileOp (false);
-std::atomic<bool> doingVideoOp (false);
 std::vector<std::function<void()>> callbackQueue{};
 std::string qualityMode = "0";
 bool display3D = false;
@@ -143,10 +161,6 @@ std::atomic doingPreload = false;
 static SDL_Thread* preloadThread = nullptr;
 static AsyncData asyncData{};
 
-zmq::context_t signalContext{1};
-zmq::socket_t signalSend{};
-std::string signalEndpoint;
-
 static std::string packageFolder = "Package";
 static std::string envFolder = "Environment";
 static std::string depthGenExe = "DepthGenerate.py";
@@ -157,8 +171,11 @@ std::filesystem::path homeDir = Core::getHomeDirectory();
 std::filesystem::path homePath = homeDir / ".Rendepth";
 std::filesystem::path tempPath = "Temp/";
 static std::filesystem::path tempFolder = homePath / tempPath;
-static std::string nextFileToConvert;
-static int nextIndexToConvert = -1;
+std::filesystem::path cachePath = "Cache/";
+std::filesystem::path servicePath = "Service.json";
+std::filesystem::path serviceLogPath = "Service.log";
+std::filesystem::path metricsPath = "Metrics.json";
+static auto serviceIdleTimeout = 600;
 
 static std::random_device randDevice;
 static std::mt19937 randGen(randDevice());
@@ -171,7 +188,8 @@ enum GenMode {
 	SINGLE_IMAGE = 0,
 	BATCH_FOLDER = 1,
 	REAL_TIME = 2,
-	VIDEO_FRAME = 3
+	VIDEO_FRAME = 3,
+	SERVICE_DAEMON = 4
 };
 
 static glm::vec2 refreshWindowSize();
@@ -229,8 +247,6 @@ void gotoPreviousImage() {
 	if (display3D) {
 		if (fileList[previousIndex].type == Color_Only) {
 			fileIndex = previousIndex;
-			SDL_DestroySurface(fileList[fileIndex].preload);
-			fileList[fileIndex].preload = nullptr;
 			callDepthGen(previousIndex);
 			return;
 		}
@@ -252,8 +268,6 @@ void gotoNextImage() {
 	if (display3D) {
 		if (fileList[nextIndex].type == Color_Only) {
 			fileIndex = nextIndex;
-			SDL_DestroySurface(fileList[fileIndex].preload);
-			fileList[fileIndex].preload = nullptr;
 			callDepthGen(nextIndex);
 			return;
 		}
@@ -307,8 +321,6 @@ void gotoRandomImage() {
 	if (display3D || preferredStereoMode == Depth_Zoom) {
 		if (fileList[randIndex].type == Color_Only) {
 			fileIndex = randIndex;
-			SDL_DestroySurface(fileList[randIndex].preload);
-			fileList[randIndex].preload = nullptr;
 			callDepthGen(randIndex);
 			return;
 		}
@@ -340,8 +352,14 @@ static void toggleStereo();
 static void toggleStereoSettings();
 static void parseFileList(const std::vector<std::string>& filesToLoad);
 static int callDepthGenOnce(const std::string& fileFolderPath, int genMode, int imageId = -1);
+static void updateBatchProgress(double timeNow);
 static int loadImage(void* ptr);
 static void conversionCompleted(const char* path, int imageId = -1);
+static void depthCompleted(DepthResult& result);
+static void speculativeCompleted(DepthResult& result);
+static void refinementCompleted(DepthResult& result);
+static void submitSpeculative(int imageIndex, const SDL_Surface* color);
+static void scheduleSpeculative();
 
 static auto actionSize = 16.0;
 static auto actionMargin = 5.0;
@@ -722,9 +740,19 @@ Choice ChoiceExport {
 		"Free View", "Free View LRL", "Light Field LKG", "Light Field CV" },
 };
 
+Choice ChoiceQuality {
+	"Export Quality",
+	{ "Standard", "High", "Very High", "Maximum" },
+};
+
+Choice ChoiceLossless {
+	"Lossless Export",
+	{ "Color + Depth", "All Formats", "Off" },
+};
+
 Choice ChoiceModel {
 	"Depth Conversion",
-	{ "Performance", "Balanced", "Quality" },
+	{ "Performance", "Balanced", "Quality", "Progressive" },
 };
 
 Choice ChoiceResolution {
@@ -757,12 +785,15 @@ Choice ChoiceEyes {
 	{ "Left / Right", "Right / Left" },
 };
 
-static std::vector menuChoices = { ChoiceStereo, ChoiceExport, ChoiceModel, ChoiceResolution,
+static std::vector menuChoices = { ChoiceStereo, ChoiceExport, ChoiceQuality, ChoiceLossless,
+	ChoiceModel, ChoiceResolution,
 	ChoiceBackground, ChoiceSorting, ChoiceSlideshow,ChoiceEyes, ChoiceTags  };
 
 static std::unordered_map<std::string, int> menuSelection = {
 	{ ChoiceStereo.label, 0 },
 	{ ChoiceExport.label, 0 },
+	{ ChoiceQuality.label, 0 },
+	{ ChoiceLossless.label, 0 },
 	{ ChoiceModel.label, 0 },
 	{ ChoiceResolution.label, 0 },
 	{ ChoiceBackground.label, 0 },
@@ -775,6 +806,8 @@ static std::unordered_map<std::string, int> menuSelection = {
 static std::unordered_map<std::string, int> menuRollover = {
 	{ ChoiceStereo.label, -1 },
 	{ ChoiceExport.label, -1 },
+	{ ChoiceQuality.label, -1 },
+	{ ChoiceLossless.label, -1 },
 	{ ChoiceModel.label, -1 },
 	{ ChoiceResolution.label, -1 },
 	{ ChoiceBackground.label, -1 },
@@ -805,20 +838,18 @@ static void changeExport(int option) {
 	exportTag = exportTags[option];
 }
 
-static std::string removeFileTags(const std::string& fileName) {
-	std::string tagPattern = "(";
-	for (auto& tag : tagType) {
-		if (tag.second != Side_By_Side_Swap)
-			tagPattern += tag.first + "|";
-	}
-	tagPattern.pop_back();
-	tagPattern += ")";
-	std::regex pattern(tagPattern);
-	return std::regex_replace(fileName, pattern, "");
+static std::array exportQualities = { 65, 80, 90, 97 };
+static void changeQuality(int option) {
+	Export::quality = exportQualities[option];
+}
+
+static auto losslessExport = 0;
+static void changeLossless(int option) {
+	losslessExport = option;
 }
 
 static bool addStereoTag(const std::string& link, const std::string& tag) {
-	std::string cleanLink = removeFileTags(link);
+	std::string cleanLink = Core::removeFileTags(link);
 	auto dotPos = cleanLink.find_last_of('.');
 	auto baseName = cleanLink.substr(0, dotPos);
 	auto ext = cleanLink.substr(dotPos);
@@ -847,31 +878,29 @@ static void changeEyes(int option) {
 	swapLeftRight = eyesFormat == Right_Left;
 }
 
-static auto depthCloseWait = 1200;
 static void endPreload(bool success);
-static void sendDepthQuit();
 static void deleteTempFiles(const std::filesystem::path& folder);
 static auto depthRegenerated = false;
-static void resetDepthGeneration() {
-	depthPipeAlive = false;
+static void resetDepthGeneration(bool shutdown = true) {
 	depthGenAlive = false;
 	depthRegenerated = true;
 	endPreload(false);
 	deleteTempFiles(tempFolder);
-	nextFileToConvert.clear();
-	nextIndexToConvert = -1;
-	sendDepthQuit();
+	Service::stop(shutdown);
+	for (auto& file : fileList) {
+		file.depth.clear();
+		file.cacheKey.clear();
+		file.provisional = false;
+		if (file.type == Color_Only) file.path = file.link;
+	}
 }
 
 static void closeDepthGeneration() {
-	if (signalContext.handle()) {
-		signalContext.close();
-		signalContext.shutdown();
-	}
+	Service::close();
 }
 
-static std::array<std::string, 3> depthQuality = { "0", "1", "2" };
-static std::array<std::string, 3> depthSizes = { "560", "640", "720" };
+static std::array<std::string, 4> depthQuality = { "0", "1", "2", "3" };
+static std::array<std::string, 4> depthSizes = { "560", "640", "720", "720" };
 static void changeModel(int option, bool init) {
 	qualityMode = depthQuality[option];
 	depthSize = depthSizes[option];
@@ -884,6 +913,10 @@ static void changeResolution(int option, bool init) {
 	if (!init) resetDepthGeneration();
 }
 
+static std::string getUpscaleResolution() {
+	return Service::useSharedMemory ? "0" : upscaleResolution;
+}
+
 static std::array backgroundStyles = { Blur, Solid, Light, Dark };
 static void changeBackground(int option) {
 	context.backgroundStyle = backgroundStyles[option];
@@ -907,6 +940,8 @@ static bool firstInit = true;
 static std::unordered_map<std::string, std::function<void(int)>> menuCallback = {
 	{ ChoiceStereo.label, [](int option) { changeStereo(option); } },
 	{ ChoiceExport.label, [](int option) { changeExport(option); } },
+	{ ChoiceQuality.label, [](int option) { changeQuality(option); } },
+	{ ChoiceLossless.label, [](int option) { changeLossless(option); } },
 	{ ChoiceModel.label, [](int option) { changeModel(option, firstInit); } },
 	{ ChoiceResolution.label, [](int option) { changeResolution(option, firstInit); } },
 	{ ChoiceBackground.label,[](int option) { changeBackground(option); } },
@@ -1092,36 +1127,40 @@ static void openFolder() {
 	SDL_ShowOpenFolderDialog(openFolderCallback, &openFolderResult, context.window, nullptr, false);
 }
 
-static void saveFile() {
-	doingFileOp = true;
-	auto renderResult = Image::renderStereoImage(&context, exportFormat);
-	if (renderResult != 0) {
-		doingFileOp = false;
-		return;
-	}
+static ExportPreset getCurrentPreset() {
+	ExportPreset preset;
+	preset.quality = Export::quality;
+	preset.parameters = { (float)currentStereoStrength, (float)currentStereoDepth, (float)currentStereoOffset,
+		swapLeftRight };
+	preset.background = context.backgroundStyle;
+	return preset;
+}
 
-	auto data = Image::getExportTexture(&context, exportFormat);
+static void saveFiles(const std::vector<StereoFormat>& formats, const ExportPreset& preset) {
+	doingFileOp = true;
 	auto exportDir = std::filesystem::path(context.fileLink).parent_path();
 	if (exportDir.filename() != exportFolderName) exportDir = exportDir / exportFolderName;
-	std::string exportType = "jpg";
-
-	std::string gridInfo;
-	if (exportFormat == Light_Field_LKG) {
-		std::string aspect = std::format("{:.3f}", context.imageSize.x / context.imageSize.y);
-		gridInfo = "9x8a" + aspect;
-	}
-
 	if (!exists(exportDir)) create_directories(exportDir);
-	std::string outFileName = removeFileTags(context.fileName);
-	std::filesystem::path outFilePath = outFileName + "_" + exportTag + gridInfo + "." + exportType;
-	auto outputPath = exportDir / outFilePath;
-	IMG_SaveJPG(data, outputPath.string().c_str(), 65);
-	SDL_DestroySurface(data);
+	std::string outFileName = Core::removeFileTags(context.fileName);
+	if (!preset.name.empty()) outFileName += "_" + preset.name;
+
+	std::vector<ExportTarget> targets;
+	for (auto format : formats) {
+		auto option = std::find(exportFormats.begin(), exportFormats.end(), format) - exportFormats.begin();
+		if (option >= (int)exportFormats.size() || !Image::canRenderStereo(&context, format)) continue;
+		auto lossless = losslessExport == 1 || (losslessExport == 0 && format == Color_Plus_Depth);
+		std::string exportType = lossless ? "png" : "jpg";
+
+		std::string gridInfo;
+		if (format == Light_Field_LKG) {
+			std::string aspect = std::format("{:.3f}", context.imageSize.x / context.imageSize.y);
+			gridInfo = "9x8a" + aspect;
+		}
 
-	if (exportFormat == Light_Field_CV) {
-		nextFileToConvert = outputPath.string();
-		nextIndexToConvert = -1;
-		doingVideoOp = true;
+		std::filesystem::path outFilePath = outFileName + "_" + exportTags[option] + gridInfo + "." + exportType;
+		std::filesystem::path videoPath;
+		if (format == Light_Field_CV) videoPath = exportDir / (outFileName + "_" + exportTags[option] + ".mp4");
+		targets.push_back({ format, exportDir / outFilePath, lossless ? Encoding_Png : Encoding_Jpeg, videoPath });
 	}
 
 	auto nameMaxLen = 26;
@@ -1129,10 +1168,174 @@ static void saveFile() {
 	if (displayName.length() > nameMaxLen) {
 		displayName = displayName.substr(0, nameMaxLen - 3) + "...";
 	}
+	if (Export::submit(&context, targets, displayName, preset) < 0) {
+		doingFileOp = false;
+		return;
+	}
+
+	auto pendingCount = Export::getPendingCount();
+	std::string exportText = "Exporting " + displayName;
+	if (pendingCount > 1) exportText = "Exporting " + std::to_string(pendingCount) + " Files";
+	Core::drawText(&context, exportText, Image::helpFont, Image::helpTexture,
+		Image::helpTextSize, "Help Texture");
+	Image::displayTip = true;
+	displayTipTime = getTimeNow();
+}
+
+static void saveFile() {
+	saveFiles({ exportFormat }, getCurrentPreset());
+}
+
+static std::vector<StereoFormat> parseExportTags(const std::string& tags) {
+	std::vector<StereoFormat> formats;
+	std::stringstream tagStream(tags);
+	std::string tag;
+	while (std::getline(tagStream, tag, ',')) {
+		auto found = std::find(exportTags.begin(), exportTags.end(), tag);
+		if (found == exportTags.end()) {
+			SDL_Log("Unknown Export Format: %s.", tag.c_str());
+			continue;
+		}
+		auto format = exportFormats[found - exportTags.begin()];
+		if (std::find(formats.begin(), formats.end(), format) == formats.end()) formats.push_back(format);
+	}
+	return formats;
+}
+
+static SDL_Surface* loadColorDepth(const std::filesystem::path& path, SDL_Surface* color, std::string& source) {
+	auto type = Core::getImageType(path.filename().string());
+	if (type == Unknown_Format) type = Core::defaultImportFormat;
+	if (type != Color_Only && type != Color_Plus_Depth) {
+		SDL_DestroySurface(color);
+		return nullptr;
+	}
+	auto fromFile = color == nullptr;
+	if (fromFile) color = Core::loadImageDirect(path.string());
+	if (color == nullptr) return nullptr;
+	if (type == Color_Plus_Depth) {
+		source = "rgbd";
+		return color;
+	}
+
+	std::vector<Uint8> depth;
+	glm::ivec2 size{};
+	source = "cache";
+	auto key = fromFile ? Cache::getKey(path.string(), qualityMode, depthSize, getUpscaleResolution()) : std::string();
+	if (key.empty() || !Cache::load(key, depth, size)) {
+		SDL_Log("No Cached Depth, Estimating: %s.", path.filename().string().c_str());
+		source = "estimate";
+		if (Depth::estimate(color, depth, size) != 0) {
+			SDL_DestroySurface(color);
+			return nullptr;
+		}
+	}
+	auto colorDepth = Core::composeColorDepth(color, depth, size);
+	SDL_DestroySurface(color);
+	return colorDepth;
+}
+
+static std::vector<ViewMode> parseDisplayTags(const std::string& tags) {
+	std::vector<ViewMode> modes;
+	std::stringstream tagStream(tags);
+	std::string tag;
+	while (std::getline(tagStream, tag, ',')) {
+		auto mode = Render::getMode(tag);
+		if (mode == Native) {
+			SDL_Log("Unknown Display Mode: %s.", tag.c_str());
+			continue;
+		}
+		if (std::find(modes.begin(), modes.end(), mode) == modes.end()) modes.push_back(mode);
+	}
+	return modes;
+}
+
+static std::vector<std::filesystem::path> expandInputs(const std::vector<std::string>& inputs) {
+	std::vector<std::filesystem::path> files;
+	for (const auto& input : inputs) {
+		if (!std::filesystem::is_directory(input)) {
+			files.emplace_back(input);
+			continue;
+		}
+		std::vector<std::filesystem::path> folderFiles;
+		for (const auto& entry : std::filesystem::directory_iterator(input)) {
+			if (isSupportedImage(entry.path().string())) folderFiles.push_back(entry.path());
+		}
+		std::sort(folderFiles.begin(), folderFiles.end());
+		files.insert(files.end(), folderFiles.begin(), folderFiles.end());
+	}
+	return files;
+}
+
+static int runZoomExport(const std::vector<std::string>& inputs) {
+	return Clip::exportZoom(expandInputs(inputs), [](const std::filesystem::path& path) {
+		std::string source;
+		return loadColorDepth(path, nullptr, source);
+	});
+}
+
+static int runServer() {
+	Server::defaultPreset = ExportPreset{};
+	Server::presets = exportPresets;
+	return Server::run(serveEndpoint, loadColorDepth);
+}
+
+static int runPresetExport(const std::vector<std::string>& inputs, const std::vector<ExportPreset>& presets) {
+	return Preset::exportBatch(expandInputs(inputs), presets, [](const std::filesystem::path& path) {
+		std::string source;
+		return loadColorDepth(path, nullptr, source);
+	});
+}
+
+static int runDisplayExport(const std::vector<std::string>& inputs) {
+	std::vector<ExportPreset> presets;
+	for (auto mode : displayRequest) {
+		ExportPreset preset;
+		preset.name = preset.format = Render::getModeTag(mode);
+		preset.encoding = Encoding_Png;
+		preset.width = Clip::width;
+		preset.height = Clip::height;
+		presets.push_back(preset);
+	}
+	return runPresetExport(inputs, presets);
+}
+
+static void updateExportRequest() {
+	if (exportRequest.empty() || fileList.empty() || context.loading || isConverting || doingPreload ||
+		switchedImage) return;
+	if (context.imageType == Color_Only) {
+		if (exportDepthRequested) {
+			SDL_Log("Export Skipped, No Depth for %s.", context.fileName.c_str());
+			exportRequest.clear();
+			quitAfterExport = true;
+			return;
+		}
+		exportDepthRequested = true;
+		callDepthGen(fileIndex);
+		setDisplay3D(true);
+		refreshDisplay3D(fileList[fileIndex].type);
+		return;
+	}
+	if (exportPresets.empty()) saveFiles(exportRequest, getCurrentPreset());
+	for (const auto& preset : exportPresets) saveFiles(exportRequest, preset);
+	exportRequest.clear();
+	quitAfterExport = true;
+}
+
+static void exportCompleted(const ExportResult& exportResult) {
+	if (exportResult.error) {
+		Core::drawText(&context, "Export Failed", Image::helpFont, Image::helpTexture,
+			Image::helpTextSize, "Help Texture");
+		Image::displayTip = true;
+		displayTipTime = getTimeNow();
+		return;
+	}
+
 	std::string toType = " to 3D";
-	if (exportFormat == Color_Only) toType = " to 2D";
-	Core::drawText(&context, "Saved " + displayName + toType,
-		Image::helpFont, Image::helpTexture,
+	if (exportResult.format == Color_Only) toType = " to 2D";
+	std::string savedText = "Saved " + exportResult.displayName + toType;
+	auto pendingCount = Export::getPendingCount();
+	if (pendingCount > 0) savedText += ", " + std::to_string(pendingCount) + " Left";
+	Core::drawText(&context, savedText, Image::helpFont, Image::helpTexture,
 		Image::helpTextSize, "Help Texture");
 	Image::displayTip = true;
 	displayTipTime = getTimeNow();
@@ -1400,6 +1603,8 @@ void toggleStereo() {
 	if (display3D && fileList[fileIndex].type == Color_Plus_Depth &&
 		preferredStereoMode == Mono) {
 		fileList[fileIndex].path = fileList[fileIndex].link;
+		fileList[fileIndex].depth.clear();
+		fileList[fileIndex].provisional = false;
 		switchedImage = true;
 	}
 	setDisplay3D(!display3D);
@@ -1439,6 +1644,8 @@ static void setSlideshow(bool slide) {
 		if (currentStereoMode == Depth_Zoom) {
 			if (defaultStereoMode == Mono) {
 				fileList[fileIndex].path = fileList[fileIndex].link;
+				fileList[fileIndex].depth.clear();
+				fileList[fileIndex].provisional = false;
 				fileList[fileIndex].type = Color_Only;
 				SDL_DestroySurface(fileList[fileIndex].preload);
 				fileList[fileIndex].preload = nullptr;
@@ -1502,6 +1709,10 @@ static void pushFileInfo(const std::filesystem::path& filePath) {
 		info.date = std::format("{:%Y-%m-%d}", modifiedTime);
 		info.modified = modifiedTime;
 		info.preload = nullptr;
+		info.preloadType = Unknown_Format;
+		info.depthSize = { 0, 0 };
+		info.cacheKey = "";
+		info.provisional = false;
 		info.type = Core::getImageType(info.name);
 		if (info.type == Unknown_Format) info.type = Core::defaultImportFormat;
 		fileList.push_back(info);
@@ -1580,7 +1791,12 @@ static void endPreload(bool success) {
 		int asyncId;
 		SDL_WaitThread(preloadThread, &asyncId);
 		if (asyncData.surface != nullptr && asyncData.fileIndex >= 0 && !fileList.empty()) {
-			preloadComplete(asyncData.surface, fileList[asyncData.fileIndex]);
+			if (asyncData.path == fileList[asyncData.fileIndex].path) {
+				preloadComplete(asyncData.surface, fileList[asyncData.fileIndex]);
+				submitSpeculative(asyncData.fileIndex, asyncData.surface);
+			} else {
+				SDL_DestroySurface(asyncData.surface);
+			}
 		}
 	} else {
 		SDL_DetachThread(preloadThread);
@@ -1651,11 +1867,38 @@ static SDL_HitTestResult windowHitCallback(SDL_Window* window,
 }
 SDL_AppResult SDL_AppInit(void** appstate, int argc, char** argv) {
 	std::string fileToLoad{};
-	if (argc >= 2) fileToLoad = std::string(argv[1]);
+	std::vector<std::string> inputs;
+	for (auto i = 1; i < argc; ++i) {
+		std::string argument = argv[i];
+		if (argument == "--export" && i + 1 < argc) exportRequest = parseExportTags(argv[++i]);
+		else if (argument == "--zoom" && i + 1 < argc) {
+			zoomExport = true;
+			Clip::output = argv[++i];
+		} else if (argument == "--display" && i + 1 < argc) displayRequest = parseDisplayTags(argv[++i]);
+		else if (argument == "--serve" && i + 1 < argc) serveEndpoint = argv[++i];
+		else if (argument == "--workers" && i + 1 < argc) Server::workerCount = std::atoi(argv[++i]);
+		else if (argument == "--no-shared") Service::useSharedMemory = false;
+		else if (argument == "--preset" && i + 1 < argc) presetPaths.push_back(argv[++i]);
+		else if (argument == "--output" && i + 1 < argc) Preset::outputFolder = argv[++i];
+		else if (argument == "--frames" && i + 1 < argc) Clip::frameCount = std::atoi(argv[++i]);
+		else if (argument == "--fps" && i + 1 < argc) Clip::frameRate = std::atoi(argv[++i]);
+		else if (argument == "--effect" && i + 1 < argc) {
+			std::string effect = argv[++i];
+			Clip::effect = effect == "zoom" ? 0 : effect == "dolly" ? 1 : -1;
+		} else if (argument == "--format" && i + 1 < argc) {
+			Clip::format = std::string(argv[++i]) == "png" ? Clip_Png : Clip_Y4m;
+		} else if (argument == "--size" && i + 1 < argc) {
+			std::sscanf(argv[++i], "%dx%d", &Clip::width, &Clip::height);
+		} else {
+			inputs.push_back(argument);
+			if (fileToLoad.empty()) fileToLoad = argument;
+		}
+	}
 
 	context.appName = "Rendepth";
 	context.windowSize = { 1920, 1080 };
 	context.appIcons = &appIcons;
+	menuChoices[5].disabled = Service::useSharedMemory;
 	context.menuChoices = &menuChoices;
 	context.menuSelection = &menuSelection;
 	context.menuRollover = &menuRollover;
@@ -1673,11 +1916,22 @@ SDL_AppResult SDL_AppInit(void** appstate, int argc, char** argv) {
 	context.backgroundStyle = Blur;
 	context.effectRandom = 0;
 	context.swapLeftRight = false;
+	Cache::cacheFolder = homePath / cachePath;
+	Service::daemonFile = homePath / servicePath;
+	Service::daemonLog = homePath / serviceLogPath;
+	Service::metricsFile = homePath / metricsPath;
 
 	loadOptions();
 
 	firstInit = false;
 
+	if (Preset::loadPresets(presetPaths, exportPresets) != 0) return SDL_APP_FAILURE;
+	if (zoomExport) return runZoomExport(inputs) == 0 ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+	if (!displayRequest.empty()) return runDisplayExport(inputs) == 0 ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+	if (!serveEndpoint.empty()) return runServer() == 0 ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+	if (!exportPresets.empty() && exportRequest.empty())
+		return runPresetExport(inputs, exportPresets) == 0 ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+
 	if (!fileToLoad.empty())
 		parseFileList({ fileToLoad });
 
@@ -1722,6 +1976,7 @@ static int loadImage(void* ptr) {
 	targetVisibility = 0.0;
 	auto result = Image::load(&context, fileList[fileIndex], fileList[fileIndex].preload);
 	fileList[fileIndex].preload = nullptr;
+	depthSwapPending = false;
 	doneLoadingImage = true;
 	return result;
 }
@@ -1744,6 +1999,7 @@ SDL_AppResult SDL_AppIterate(void* appstate) {
 	Image::infoCurrentVisibility = Utils::tween(Image::infoCurrentVisibility,
 		Image::infoTargetVisibility, visibilitySpeed * deltaAverage);
 
+	if (depthSwapPending) switchedImage = true;
 	if (switchedImage) {
 		if (context.loading) {
 			switchedImage = false;
@@ -1784,7 +2040,7 @@ SDL_AppResult SDL_AppIterate(void* appstate) {
 		context.effectRandom = randEffect(randGen);
 		switchedImage = false;
 		lastSlideshowTime = timeNow;
-		menuChoices[8].active = true;
+		menuChoices[10].active = true;
 		menuSelection[ChoiceTags.label] = 0;
 		if (Core::defaultImportFormat == Color_Only) menuSelection[ChoiceTags.label] = 0;
 		else if (Core::defaultImportFormat == Color_Anaglyph) menuSelection[ChoiceTags.label] = 1;
@@ -1792,6 +2048,7 @@ SDL_AppResult SDL_AppIterate(void* appstate) {
 		else if (Core::defaultImportFormat == Side_By_Side_Half) menuSelection[ChoiceTags.label] = 3;
 		if (isPlayingSlideshow) preloadImage(nextRandIndex);
 		else preloadImage();
+		scheduleSpeculative();
 		if (display3D && !isFullscreen && showGoFullScreenOnce && (context.mode == SBS_Full ||
 				context.mode == SBS_Half || context.mode == RGB_Depth)) {
 			Core::drawText(&context, "Go Full-Screen to View in Stereo",
@@ -1956,17 +2213,52 @@ SDL_AppResult SDL_AppIterate(void* appstate) {
 		isConverting = false;
 	}
 
-	if (depthPipeError) {
-		nextFileToConvert.clear();
-		nextIndexToConvert = -1;
-		context.loading = false;
-		justConverted = false;
-		isConverting = false;
-		SDL_SetWindowTitle(context.window, context.appName);
-		Core::drawText(&context, "Could Not Load Image", Image::helpFont, Image::helpTexture,
-			Image::helpTextSize, "Help Texture");
-		Image::displayHelp = true;
-		depthPipeError = false;
+	updateBatchProgress(timeNow);
+
+	updateExportRequest();
+	Export::update(&context);
+	ExportResult exportResult{};
+	while (Export::poll(exportResult)) exportCompleted(exportResult);
+	if (quitAfterExport && Export::getPendingCount() == 0) quitAppNextFrame = true;
+
+	static auto serviceReady = false;
+	if (Service::isReady() != serviceReady) {
+		serviceReady = !serviceReady;
+		if (serviceReady && Image::displayTip) {
+			Core::drawText(&context, "Depth Model Ready, " + Service::getReadyInfo(),
+				Image::helpFont, Image::helpTexture,
+				Image::helpTextSize, "Help Texture");
+			displayTipTime = getTimeNow();
+		}
+	}
+
+	DepthResult depthResult{};
+	while (Service::poll(depthResult)) {
+		auto imageResult = depthResult.imageId >= 0 && depthResult.imageId < fileList.size();
+		if (imageResult && depthResult.draft) fileList[depthResult.imageId].cacheKey.clear();
+		if (imageResult && depthResult.refined) {
+			refinementCompleted(depthResult);
+		} else if (imageResult && !(isConverting && depthResult.imageId == fileIndex)) {
+			speculativeCompleted(depthResult);
+		} else if (depthResult.error) {
+			if (depthResult.imageId < 0) continue;
+			if (fileList[depthResult.imageId].provisional) {
+				fileList[depthResult.imageId].depth.clear();
+				fileList[depthResult.imageId].provisional = false;
+				fileList[depthResult.imageId].type = Color_Only;
+			}
+			context.loading = false;
+			justConverted = false;
+			isConverting = false;
+			SDL_SetWindowTitle(context.window, context.appName);
+			Core::drawText(&context, "Could Not Load Image", Image::helpFont, Image::helpTexture,
+				Image::helpTextSize, "Help Texture");
+			Image::displayHelp = true;
+		} else if (!depthResult.depth.empty() && depthResult.imageId >= 0 && depthResult.imageId < fileList.size()) {
+			depthCompleted(depthResult);
+		} else if (depthResult.imageId >= 0 && depthResult.imageId < fileList.size()) {
+			conversionCompleted(depthResult.path.c_str(), depthResult.imageId);
+		}
 	}
 
 	if (windowDraggable && isFullscreen) {
@@ -1978,7 +2270,7 @@ SDL_AppResult SDL_AppIterate(void* appstate) {
 		}
 	}
 
-	if (quitAppNextFrame && !doingVideoOp) return SDL_APP_SUCCESS;
+	if (quitAppNextFrame && Export::getPendingCount() == 0) return SDL_APP_SUCCESS;
 	return SDL_APP_CONTINUE;
 }
 
@@ -2089,6 +2381,7 @@ void checkMouseState() {
 		for (const auto& choice : *context.menuChoices) {
 			auto optionIndex = 0;
 			(*context.menuRollover)[choice.label] = -1;
+			if (choice.disabled) continue;
 			for (const auto& option : choice.options) {
 				if (withinArea(glm::vec2(context.mouse.x, windowSize.y - context.mouse.y),
 					choice.layouts[optionIndex].position * glm::vec3(1.0)
@@ -2157,94 +2450,120 @@ static void deleteTempFiles(const std::filesystem::path& folder) {
 	}
 }
 
+static void reuseColorSurface(FileInfo& file) {
+	if (file.preload == nullptr && Image::colorSurface != nullptr && Image::colorLink == file.link) {
+		file.preload = Image::colorSurface;
+		Image::colorSurface = nullptr;
+	}
+}
+
 static void conversionCompleted(const char* path, int imageId) {
 	auto colorPath = std::filesystem::path(fileList[imageId].path).filename().replace_extension();;
 	auto depthPath = std::filesystem::path(path).filename().replace_extension();;
-	if (imageId == fileIndex) fileList[imageId].path = path;
-	nextFileToConvert.clear();
-	nextIndexToConvert = -1;
+	if (imageId == fileIndex) {
+		fileList[imageId].path = path;
+		if (fileList[imageId].provisional) fileList[imageId].depth.clear();
+		fileList[imageId].provisional = false;
+		SDL_DestroySurface(fileList[imageId].preload);
+		fileList[imageId].preload = nullptr;
+	}
 	context.loading = false;
 	switchedImage = true;
 	justConverted = true;
 	isConverting = false;
 }
 
-static int depthGenRun(void* ptr) {
-	if (depthGenAlive) {
-		auto packagePath = homePath / packageFolder;
-		auto depthPath = packagePath / depthGenExe;
-#ifdef WIN32
-		auto pythonPath = homePath / envFolder / "Scripts" / "python.exe";
-#else
-		auto pythonPath = homePath / envFolder / "bin" / "python3";
-#endif
+static void depthCompleted(DepthResult& result) {
+	auto& file = fileList[result.imageId];
+	file.depth = std::move(result.depth);
+	file.depthSize = { result.depthWidth, result.depthHeight };
+	if (file.provisional && result.imageId == fileIndex) depthSwapPending = true;
+	file.provisional = false;
+	Cache::store(file.cacheKey, file.depth, file.depthSize);
+	file.cacheKey.clear();
+	reuseColorSurface(file);
+	context.loading = false;
+	switchedImage = true;
+	justConverted = true;
+	isConverting = false;
+}
+
+static void speculativeCompleted(DepthResult& result) {
+	auto& file = fileList[result.imageId];
+	if (result.error || file.type != Color_Only || file.path != file.link) {
+		file.cacheKey.clear();
+		return;
+	}
+	if (!result.depth.empty()) {
+		file.depth = std::move(result.depth);
+		file.depthSize = { result.depthWidth, result.depthHeight };
+		Cache::store(file.cacheKey, file.depth, file.depthSize);
+		file.cacheKey.clear();
+	} else {
+		file.path = result.path;
+		SDL_DestroySurface(file.preload);
+		file.preload = nullptr;
+	}
+}
+
+static void refinementCompleted(DepthResult& result) {
+	auto& file = fileList[result.imageId];
+	if (result.error) return;
+	if (result.depth.empty()) {
+		if (file.path == file.link) return;
+		file.path = result.path;
+		SDL_DestroySurface(file.preload);
+		file.preload = nullptr;
+	} else {
+		if (file.path != file.link) return;
+		file.depth = std::move(result.depth);
+		file.depthSize = { result.depthWidth, result.depthHeight };
+		file.provisional = false;
+	}
+	file.cacheKey = Cache::getKey(file.link, qualityMode, depthSize, getUpscaleResolution());
+	if (!file.depth.empty()) {
+		Cache::store(file.cacheKey, file.depth, file.depthSize);
+		file.cacheKey.clear();
+	}
+	if (result.imageId != fileIndex || file.type != Color_Plus_Depth || context.loading) return;
+	if (!file.depth.empty()) reuseColorSurface(file);
+	Image::load(&context, file, file.preload);
+	file.preload = nullptr;
+}
 
-		auto command = static_cast<std::string*>(ptr);
+static std::filesystem::path getPythonPath() {
 #ifdef WIN32
-		ShellExecute(nullptr, "open", pythonPath.string().c_str(),
-			(depthPath.string() + " " + (*command)).c_str(), nullptr, SW_HIDE);
+	return homePath / envFolder / "Scripts" / "python.exe";
 #else
-		auto success = system((pythonPath.string() + " " +  depthPath.string() + " " + (*command)).c_str());
+	return homePath / envFolder / "bin" / "python3";
 #endif
-	}
-	return 0;
 }
 
-static void sendDepthQuit() {
-	if (signalSend.handle()) {
-		constexpr auto quitMessage = std::string_view("quit");
-		try {
-			signalSend.send(zmq::buffer(quitMessage), zmq::send_flags::none);
-		} catch (const zmq::error_t& error) {
-			return;
-		}
-		signalSend.close();
-	}
-}
-
-static int depthPipeRun(void* ptr) {
-	while (depthPipeAlive) {
-		if (!nextFileToConvert.empty()) {
-			const std::string_view fileMessage = std::string_view(nextFileToConvert);
-			signalSend.send(zmq::buffer(fileMessage), zmq::send_flags::none);
-			zmq::message_t message;
-			auto result = signalSend.recv(message, zmq::recv_flags::none);
-			auto reply = message.to_string();
-			std::filesystem::path resultPath = reply;
-			if (resultPath.extension() == ".mp4") {
-				nextFileToConvert.clear();
-				nextIndexToConvert = -1;
-				isConverting = false;
-				doingVideoOp = false;
-				auto resultFileName = resultPath.filename();
-				auto exportDir = std::filesystem::path(context.fileLink).parent_path();
-				if (exportDir.filename() != exportFolderName) exportDir = exportDir / exportFolderName;
-				try {
-					std::filesystem::copy(resultPath, exportDir / resultFileName,
-						std::filesystem::copy_options::overwrite_existing);
-				} catch (const std::filesystem::filesystem_error& e) {
-				}
-			} else if (reply != "ERROR") {
-				conversionCompleted(reply.c_str(), nextIndexToConvert);
-			} else {
-				depthPipeError = true;
-			}
-		}
+static int depthGenRun(void* ptr) {
+	auto arguments = static_cast<std::vector<std::string>*>(ptr);
+	if (depthGenAlive) {
+		ProcessHandle process;
+		auto program = arguments->front();
+		arguments->erase(arguments->begin());
+		if (Process::spawn(process, program, *arguments) == 0) Process::wait(process, 0);
+		Process::release(process);
 	}
+	delete arguments;
 	return 0;
 }
 
-static void	setupDepthSignal() {
-	signalSend = zmq::socket_t(signalContext, zmq::socket_type::req);
-	signalSend.bind("tcp://127.0.0.1:*");
-	signalEndpoint = signalSend.get(zmq::sockopt::last_endpoint);
+static int batchGenRun(void* ptr) {
+	depthGenRun(ptr);
+	batchRunning = false;
+	return 0;
 }
 
 static int callDepthGenOnce(const std::string& fileFolderPath, int genMode, int imageId) {
 	auto packagePath = homePath / packageFolder;
 	auto depthPath = packagePath / depthGenExe;
+	auto standIn = SDL_getenv("RENDEPTH_STAND_IN");
 
-	if (!exists(depthPath)) {
+	if (!exists(depthPath) && standIn == nullptr) {
 		Core::drawText(&context, "\"DepthGenerate\" Not Found, Check Install Instructions", Image::helpFont,
 			Image::helpTexture, Image::helpTextSize, "Help Texture");
 		Image::displayTip = true;
@@ -2253,46 +2572,200 @@ static int callDepthGenOnce(const std::string& fileFolderPath, int genMode, int
 		return 1;
 	}
 
+	if (genMode == REAL_TIME) {
+		Service::daemonSettings = qualityMode + " " + depthSize + " " + getUpscaleResolution() + " " +
+			std::to_string(Image::maxConversionSize);
+		auto launch = Service::start();
+		if (launch < 0) {
+			isConverting = false;
+			return 1;
+		}
+		if (launch == 0) return 0;
+		if (Service::useDaemon) genMode = SERVICE_DAEMON;
+	}
+
 	Core::drawText(&context, "Loading Depth Model, Please Wait",
 		Image::helpFont, Image::helpTexture,
 		Image::helpTextSize, "Help Texture");
 	Image::displayTip = true;
 	displayTipTime = getTimeNow();
 
-	std::string service = std::to_string(genMode);
-	depthCommand = "--model " + qualityMode + " --depth " + depthSize +
-		" --upscale " + upscaleResolution + " --maxsize " + std::to_string(Image::maxConversionSize) +
-		" --mode " + service + " --base " + exePath.string() +
-		" --home " + homePath.string() + " --input \"";
-	depthCommand += fileFolderPath + "\"";
-	if (genMode == REAL_TIME) {
-		setupDepthSignal();
-		depthCommand += " --endpoint " + signalEndpoint;
+	std::vector<std::string> arguments = { "-u", depthPath.string(), "--model", qualityMode,
+		"--depth", depthSize, "--upscale", getUpscaleResolution(),
+		"--maxsize", std::to_string(Image::maxConversionSize), "--mode", std::to_string(genMode),
+		"--base", exePath.string(), "--home", homePath.string(), "--input", fileFolderPath };
+	if (genMode == REAL_TIME) arguments.insert(arguments.end(), { "--endpoint", Service::endpoint });
+	if (genMode == SERVICE_DAEMON) arguments.insert(arguments.end(), { "--idle", std::to_string(serviceIdleTimeout) });
+	auto program = getPythonPath().string();
+	if (standIn != nullptr) {
+		program = standIn;
+		arguments.erase(arguments.begin(), arguments.begin() + 2);
 	}
 
 	createTempFolder(tempFolder);
 
 	depthGenAlive = true;
-	depthGenThread = SDL_CreateThread(depthGenRun, "depthGenRun", &depthCommand);
+	if (genMode == REAL_TIME || genMode == SERVICE_DAEMON) {
+		if (Service::launch(program, arguments) != 0) {
+			Service::stop();
+			isConverting = false;
+			return 1;
+		}
+		return 0;
+	}
+	if (genMode == BATCH_FOLDER) {
+		batchManifestPath = std::filesystem::path(fileFolderPath) / exportFolderName / "Manifest.json";
+		batchProgressText.clear();
+		batchRunning = true;
+	}
+	arguments.insert(arguments.begin(), program);
+	depthGenThread = SDL_CreateThread(genMode == BATCH_FOLDER ? batchGenRun : depthGenRun, "depthGenRun",
+		new std::vector<std::string>(arguments));
 	SDL_DetachThread(depthGenThread);
 
-	if (genMode == REAL_TIME) {
-		nextFileToConvert = fileFolderPath;
-		nextIndexToConvert = imageId;
-		depthPipeAlive = true;
-		depthPipeThread = SDL_CreateThread(depthPipeRun, "depthPipeRun", nullptr);
-		SDL_DetachThread(depthPipeThread);
-	}
 	return 0;
 }
 
+static void updateBatchProgress(double timeNow) {
+	if (batchManifestPath.empty() || timeNow - batchProgressTime < batchProgressWait) return;
+	batchProgressTime = timeNow;
+	auto running = batchRunning.load();
+
+	size_t dataSize = 0;
+	auto data = static_cast<char*>(SDL_LoadFile(batchManifestPath.string().c_str(), &dataSize));
+	rapidjson::Document document;
+	auto parsed = data != nullptr && !document.Parse(data, dataSize).HasParseError() && document.IsObject() &&
+		document.HasMember("progress") && document["progress"].IsObject();
+	SDL_free(data);
+	if (!parsed) {
+		if (!running) batchManifestPath.clear();
+		return;
+	}
+
+	auto& progress = document["progress"];
+	auto getCount = [&progress](const char* name) {
+		return progress.HasMember(name) && progress[name].IsInt() ? progress[name].GetInt() : 0;
+	};
+	auto finished = progress.HasMember("running") && progress["running"].IsBool() && !progress["running"].GetBool();
+	if (running && finished) return;
+
+	auto done = getCount("done");
+	auto failed = getCount("failed");
+	auto text = std::format("Converted {} of {} to Depth", done, getCount("total"));
+	if (!running) {
+		text = std::format("Batch Complete, {} Converted", done - getCount("skipped"));
+		batchManifestPath.clear();
+	}
+	if (failed > 0) text += std::format(", {} Failed", failed);
+	if (text == batchProgressText) return;
+	batchProgressText = text;
+
+	Core::drawText(&context, text, Image::helpFont, Image::helpTexture, Image::helpTextSize, "Help Texture");
+	Image::displayTip = true;
+	displayTipTime = timeNow;
+}
+
+static SDL_Surface* getConversionSurface(int imageIndex) {
+	auto& file = fileList[imageIndex];
+	reuseColorSurface(file);
+	if (file.preload == nullptr) file.preload = Core::loadImageDirect(file.link);
+	if (file.preload == nullptr || file.preload->w * 2 > Image::maxImageSize) return nullptr;
+	return file.preload;
+}
+
+static void showDepthPreview(int imageIndex) {
+	auto& file = fileList[imageIndex];
+	if (!Depth::usePreview || !file.depth.empty()) return;
+	auto color = getConversionSurface(imageIndex);
+	if (color == nullptr || Depth::estimate(color, file.depth, file.depthSize) != 0) return;
+	file.provisional = true;
+	depthSwapPending = true;
+	justConverted = true;
+}
+
 static void callDepthGen(int imageIndex) {
+	auto& file = fileList[imageIndex];
+	auto ready = (!file.depth.empty() && !file.provisional) || file.path != file.link;
+	if (!ready && !Service::isPending(imageIndex)) {
+		file.cacheKey = Cache::getKey(file.link, qualityMode, depthSize, getUpscaleResolution());
+		ready = Cache::load(file.cacheKey, file.depth, file.depthSize);
+		if (ready) {
+			file.cacheKey.clear();
+			file.provisional = false;
+		}
+	}
+	if (ready) {
+		context.loading = false;
+		switchedImage = true;
+		justConverted = true;
+		isConverting = false;
+		return;
+	}
 	isConverting = true;
-	if (!depthPipeAlive) {
-		callDepthGenOnce(fileList[imageIndex].link, REAL_TIME, imageIndex);
-	} else {
-		nextFileToConvert = fileList[imageIndex].link;
-		nextIndexToConvert = imageIndex;
+	if (!Service::promote(imageIndex)) {
+		if (!Service::isRunning() && callDepthGenOnce(fileList[imageIndex].link, REAL_TIME, imageIndex) != 0) return;
+		Service::submit(fileList[imageIndex].link, imageIndex, Priority_Current, getConversionSurface(imageIndex));
+	}
+	showDepthPreview(imageIndex);
+}
+
+static auto speculativeCount = 2;
+static std::vector<int> speculativeIds;
+static void submitSpeculative(int imageIndex, const SDL_Surface* color) {
+	if (std::find(speculativeIds.begin(), speculativeIds.end(), imageIndex) == speculativeIds.end()) return;
+	auto& file = fileList[imageIndex];
+	if (file.type != Color_Only || !file.depth.empty() || file.path != file.link) return;
+	if (Service::isPending(imageIndex) || !Service::isRunning()) return;
+	file.cacheKey = Cache::getKey(file.link, qualityMode, depthSize, getUpscaleResolution());
+	if (Cache::load(file.cacheKey, file.depth, file.depthSize)) {
+		file.cacheKey.clear();
+		return;
+	}
+	if (color != nullptr && color->w * 2 > Image::maxImageSize) color = nullptr;
+	Service::submit(file.link, imageIndex, Priority_Speculative, color);
+}
+
+static void scheduleSpeculative() {
+	speculativeIds.clear();
+	if (fileList.empty()) return;
+	auto count = (int)fileList.size();
+	if (isPlayingSlideshow) {
+		if (nextRandIndex >= 0 && (display3D || preferredStereoMode == Depth_Zoom))
+			speculativeIds.push_back(nextRandIndex);
+	} else if (display3D) {
+		auto direction = preloadDir < 0 ? -1 : 1;
+		for (auto step = 1; step <= speculativeCount && step < count; ++step) {
+			for (auto side : { direction, -direction }) {
+				auto index = ((fileIndex + side * step) % count + count) % count;
+				if (index != fileIndex && std::find(speculativeIds.begin(), speculativeIds.end(), index) ==
+					speculativeIds.end()) speculativeIds.push_back(index);
+			}
+		}
+	}
+	Service::cancelSpeculative(speculativeIds);
+	auto refineIds = speculativeIds;
+	refineIds.push_back(fileIndex);
+	Service::cancelRefinement(refineIds);
+
+	for (auto index = 0; index < count; ++index) {
+		auto& file = fileList[index];
+		if (index == fileIndex || file.depth.empty() || file.path != file.link ||
+			std::find(speculativeIds.begin(), speculativeIds.end(), index) != speculativeIds.end()) continue;
+		file.depth.clear();
+		file.depth.shrink_to_fit();
+		file.provisional = false;
+		file.type = Color_Only;
+	}
+
+	std::erase_if(speculativeIds, [](int index) {
+		const auto& file = fileList[index];
+		return file.type != Color_Only || !file.depth.empty() || file.path != file.link;
+	});
+	if (speculativeIds.empty()) return;
+	if (!Service::isRunning() && callDepthGenOnce(fileList[speculativeIds.front()].link, REAL_TIME, -1) != 0) return;
+	for (auto index : speculativeIds) {
+		if (doingPreload && asyncData.fileIndex == index) continue;
+		submitSpeculative(index, fileList[index].preload);
 	}
 }
 
@@ -2571,11 +3044,12 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
 
 void SDL_AppQuit(void *appstate, SDL_AppResult result) {
 	saveOptions();
-	if (signalSend.handle()) {
-		resetDepthGeneration();
+	if (Service::isRunning()) {
+		resetDepthGeneration(false);
 		closeDepthGeneration();
 	}
-	Image::quit(&context);
-	SDL_Delay(depthCloseWait);
+	Export::close(&context);
+	if (!zoomExport && displayRequest.empty() && serveEndpoint.empty() && (exportPresets.empty() ||
+		!exportRequest.empty())) Image::quit(&context);
 	SDL_Quit();
 }
\ No newline at end of file
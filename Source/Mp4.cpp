@@ -0,0 +1,203 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Mp4.h"
+#include <algorithm>
+
+static void write16(std::vector<Uint8>& output, Uint16 value) {
+	output.insert(output.end(), { (Uint8)(value >> 8), (Uint8)value });
+}
+
+static void write32(std::vector<Uint8>& output, Uint32 value) {
+	output.insert(output.end(), { (Uint8)(value >> 24), (Uint8)(value >> 16), (Uint8)(value >> 8), (Uint8)value });
+}
+
+static void writeZeros(std::vector<Uint8>& output, size_t count) {
+	output.insert(output.end(), count, 0);
+}
+
+static void writeMatrix(std::vector<Uint8>& output) {
+	const Uint32 matrix[9] = { 0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000 };
+	for (auto value : matrix) write32(output, value);
+}
+
+size_t Mp4::beginBox(std::vector<Uint8>& output, const char* type) {
+	auto start = output.size();
+	write32(output, 0);
+	output.insert(output.end(), type, type + 4);
+	return start;
+}
+
+size_t Mp4::beginFullBox(std::vector<Uint8>& output, const char* type, Uint8 version, Uint32 flags) {
+	auto start = beginBox(output, type);
+	write32(output, (Uint32)version << 24 | (flags & 0xFFFFFF));
+	return start;
+}
+
+void Mp4::endBox(std::vector<Uint8>& output, size_t start) {
+	auto size = (Uint32)(output.size() - start);
+	output[start] = (Uint8)(size >> 24);
+	output[start + 1] = (Uint8)(size >> 16);
+	output[start + 2] = (Uint8)(size >> 8);
+	output[start + 3] = (Uint8)size;
+}
+
+void Mp4::writeSampleEntry(std::vector<Uint8>& output, int width, int height, Uint32 sampleSize) {
+	auto entry = beginBox(output, "mp4v");
+	writeZeros(output, 6);
+	write16(output, 1);
+	writeZeros(output, 16);
+	write16(output, (Uint16)width);
+	write16(output, (Uint16)height);
+	write32(output, 0x00480000);
+	write32(output, 0x00480000);
+	write32(output, 0);
+	write16(output, 1);
+	writeZeros(output, 32);
+	write16(output, 0x0018);
+	write16(output, 0xFFFF);
+
+	auto bufferSize = std::min(sampleSize, 0xFFFFFFu);
+	auto bitrate = (Uint32)std::min<Uint64>((Uint64)sampleSize * 8 * timeScale / std::max(frameDuration, 1u),
+		0xFFFFFFFFu);
+	auto esds = beginFullBox(output, "esds", 0, 0);
+	output.insert(output.end(), { 0x03, 21, 0x00, 0x01, 0x00 });
+	output.insert(output.end(), { 0x04, 13, 0x6C, 0x11 });
+	output.insert(output.end(), { (Uint8)(bufferSize >> 16), (Uint8)(bufferSize >> 8), (Uint8)bufferSize });
+	write32(output, bitrate);
+	write32(output, bitrate);
+	output.insert(output.end(), { 0x06, 1, 0x02 });
+	endBox(output, esds);
+	endBox(output, entry);
+}
+
+void Mp4::writeTrack(std::vector<Uint8>& output, int width, int height, Uint32 sampleSize,
+	size_t& offsetPosition) {
+	auto duration = frameDuration * 1000 / timeScale;
+	auto trak = beginBox(output, "trak");
+	auto tkhd = beginFullBox(output, "tkhd", 0, 3);
+	writeZeros(output, 8);
+	write32(output, 1);
+	write32(output, 0);
+	write32(output, duration);
+	writeZeros(output, 16);
+	writeMatrix(output);
+	write32(output, (Uint32)width << 16);
+	write32(output, (Uint32)height << 16);
+	endBox(output, tkhd);
+
+	auto mdia = beginBox(output, "mdia");
+	auto mdhd = beginFullBox(output, "mdhd", 0, 0);
+	writeZeros(output, 8);
+	write32(output, timeScale);
+	write32(output, frameDuration);
+	write16(output, 0x55C4);
+	write16(output, 0);
+	endBox(output, mdhd);
+	auto hdlr = beginFullBox(output, "hdlr", 0, 0);
+	write32(output, 0);
+	output.insert(output.end(), { 'v', 'i', 'd', 'e' });
+	writeZeros(output, 12);
+	const char name[] = "VideoHandler";
+	output.insert(output.end(), name, name + sizeof(name));
+	endBox(output, hdlr);
+
+	auto minf = beginBox(output, "minf");
+	auto vmhd = beginFullBox(output, "vmhd", 0, 1);
+	writeZeros(output, 8);
+	endBox(output, vmhd);
+	auto dinf = beginBox(output, "dinf");
+	auto dref = beginFullBox(output, "dref", 0, 0);
+	write32(output, 1);
+	endBox(output, beginFullBox(output, "url ", 0, 1));
+	endBox(output, dref);
+	endBox(output, dinf);
+
+	auto stbl = beginBox(output, "stbl");
+	auto stsd = beginFullBox(output, "stsd", 0, 0);
+	write32(output, 1);
+	writeSampleEntry(output, width, height, sampleSize);
+	endBox(output, stsd);
+	auto stts = beginFullBox(output, "stts", 0, 0);
+	write32(output, 1);
+	write32(output, 1);
+	write32(output, frameDuration);
+	endBox(output, stts);
+	auto stsc = beginFullBox(output, "stsc", 0, 0);
+	write32(output, 1);
+	write32(output, 1);
+	write32(output, 1);
+	write32(output, 1);
+	endBox(output, stsc);
+	auto stsz = beginFullBox(output, "stsz", 0, 0);
+	write32(output, 0);
+	write32(output, 1);
+	write32(output, sampleSize);
+	endBox(output, stsz);
+	auto stco = beginFullBox(output, "stco", 0, 0);
+	write32(output, 1);
+	offsetPosition = output.size();
+	write32(output, 0);
+	endBox(output, stco);
+	endBox(output, stbl);
+	endBox(output, minf);
+	endBox(output, mdia);
+	endBox(output, trak);
+}
+
+int Mp4::encode(const std::vector<Uint8>& jpeg, int width, int height, std::vector<Uint8>& output) {
+	if (jpeg.empty() || jpeg.size() > 0xFFFFFF00u || width <= 0 || height <= 0 || width > 65535 ||
+		height > 65535 || timeScale == 0) return -1;
+	auto sampleSize = (Uint32)jpeg.size();
+	output.clear();
+	output.reserve(jpeg.size() + 1024);
+
+	auto ftyp = beginBox(output, "ftyp");
+	output.insert(output.end(), { 'i', 's', 'o', 'm' });
+	write32(output, 0x200);
+	output.insert(output.end(), { 'i', 's', 'o', 'm', 'i', 's', 'o', '2', 'm', 'p', '4', '1' });
+	endBox(output, ftyp);
+
+	auto moov = beginBox(output, "moov");
+	auto mvhd = beginFullBox(output, "mvhd", 0, 0);
+	writeZeros(output, 8);
+	write32(output, 1000);
+	write32(output, frameDuration * 1000 / timeScale);
+	write32(output, 0x00010000);
+	write16(output, 0x0100);
+	writeZeros(output, 10);
+	writeMatrix(output);
+	writeZeros(output, 24);
+	write32(output, 2);
+	endBox(output, mvhd);
+	size_t offsetPosition = 0;
+	writeTrack(output, width, height, sampleSize, offsetPosition);
+	endBox(output, moov);
+
+	auto mdat = beginBox(output, "mdat");
+	auto dataOffset = (Uint32)output.size();
+	output[offsetPosition] = (Uint8)(dataOffset >> 24);
+	output[offsetPosition + 1] = (Uint8)(dataOffset >> 16);
+	output[offsetPosition + 2] = (Uint8)(dataOffset >> 8);
+	output[offsetPosition + 3] = (Uint8)dataOffset;
+	output.insert(output.end(), jpeg.begin(), jpeg.end());
+	endBox(output, mdat);
+	return 0;
+}
\ No newline at end of file
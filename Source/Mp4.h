@@ -0,0 +1,41 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RENDEPTH_MP4_H
+#define RENDEPTH_MP4_H
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+class Mp4 {
+public:
+	static int encode(const std::vector<Uint8>& jpeg, int width, int height, std::vector<Uint8>& output);
+	inline static Uint32 timeScale = 24;
+	inline static Uint32 frameDuration = 24;
+private:
+	static size_t beginBox(std::vector<Uint8>& output, const char* type);
+	static size_t beginFullBox(std::vector<Uint8>& output, const char* type, Uint8 version, Uint32 flags);
+	static void endBox(std::vector<Uint8>& output, size_t start);
+	static void writeTrack(std::vector<Uint8>& output, int width, int height, Uint32 sampleSize,
+		size_t& offsetPosition);
+	static void writeSampleEntry(std::vector<Uint8>& output, int width, int height, Uint32 sampleSize);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,510 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Png.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <queue>
+#include <thread>
+
+static const Uint16 lengthBase[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const Uint8 lengthExtra[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const Uint8 codeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+static const std::array<Uint8, 259>& getLengthSymbols() {
+	static const auto symbols = [] {
+		std::array<Uint8, 259> result{};
+		for (auto symbol = 0; symbol < 29; ++symbol) {
+			auto last = symbol == 28 ? 258 : lengthBase[symbol] + (1 << lengthExtra[symbol]) - 1;
+			for (auto length = (int)lengthBase[symbol]; length <= last; ++length) result[length] = (Uint8)symbol;
+		}
+		return result;
+	}();
+	return symbols;
+}
+
+template <typename Literal, typename Match>
+static void scanSymbols(const std::vector<Uint8>& filtered, int distance, Literal literal, Match match) {
+	auto data = filtered.data();
+	auto size = filtered.size();
+	for (size_t i = 0; i < size;) {
+		size_t length = 0;
+		if (i >= (size_t)distance) {
+			auto limit = std::min<size_t>(258, size - i);
+			auto previous = data + i - distance;
+			while (length < limit && data[i + length] == previous[length]) ++length;
+		}
+		if (length >= 3) {
+			match((int)length);
+			i += length;
+		} else {
+			literal(data[i]);
+			++i;
+		}
+	}
+}
+
+static void runParallel(int count, int threadCount, const std::function<void(int)>& work) {
+	std::atomic<int> next = 0;
+	auto run = [&]() {
+		for (auto index = next++; index < count; index = next++) work(index);
+	};
+	std::vector<std::thread> threads;
+	for (auto i = 1; i < std::min(threadCount, count); ++i) threads.emplace_back(run);
+	run();
+	for (auto& thread : threads) thread.join();
+}
+
+static void writeBigEndian(std::vector<Uint8>& output, Uint32 value) {
+	output.insert(output.end(), { (Uint8)(value >> 24), (Uint8)(value >> 16), (Uint8)(value >> 8), (Uint8)value });
+}
+
+void Png::BitWriter::write(Uint32 bits, int size) {
+	buffer |= (Uint64)bits << count;
+	count += size;
+	while (count >= 8) {
+		data.push_back((Uint8)buffer);
+		buffer >>= 8;
+		count -= 8;
+	}
+}
+
+void Png::BitWriter::align() {
+	if (count > 0) data.push_back((Uint8)buffer);
+	buffer = 0;
+	count = 0;
+}
+
+int Png::getChannels(const SDL_Surface* surface, int channels[3], SDL_Surface*& converted) {
+	channels[0] = 0;
+	channels[1] = 1;
+	channels[2] = 2;
+	converted = nullptr;
+	if (surface->format == SDL_PIXELFORMAT_BGRA32 || surface->format == SDL_PIXELFORMAT_BGRX32) {
+		channels[0] = 2;
+		channels[2] = 0;
+	} else if (surface->format != SDL_PIXELFORMAT_RGBA32 && surface->format != SDL_PIXELFORMAT_RGBX32) {
+		converted = SDL_ConvertSurface(const_cast<SDL_Surface*>(surface), SDL_PIXELFORMAT_RGBA32);
+		if (converted == nullptr) return -1;
+	}
+	return 0;
+}
+
+void Png::filterGroup(const Uint8* pixels, int pitch, int width, int rows, bool above, const int channels[3],
+	std::vector<Uint8>& filtered) {
+	auto rowSize = (size_t)width * 3;
+	filtered.resize((rowSize + 1) * rows);
+	auto output = filtered.data();
+	for (auto y = 0; y < rows; ++y) {
+		auto row = pixels + (size_t)y * pitch;
+		auto previous = above || y > 0 ? row - pitch : nullptr;
+		*output++ = previous ? 2 : 1;
+		for (auto x = 0; x < width; ++x) {
+			for (auto c = 0; c < 3; ++c) {
+				auto value = row[x * 4 + channels[c]];
+				if (previous) *output++ = (Uint8)(value - previous[x * 4 + channels[c]]);
+				else *output++ = (Uint8)(value - (x > 0 ? row[(x - 1) * 4 + channels[c]] : 0));
+			}
+		}
+	}
+}
+
+void Png::countSymbols(const std::vector<Uint8>& filtered, int distance, Uint32* literals, Uint32* distances) {
+	auto& lengthSymbols = getLengthSymbols();
+	scanSymbols(filtered, distance, [&](Uint8 value) {
+		++literals[value];
+	}, [&](int length) {
+		++literals[257 + lengthSymbols[length]];
+		++distances[distance - 1];
+	});
+}
+
+void Png::writeSymbols(const std::vector<Uint8>& filtered, int distance, const HuffmanTable& literals,
+	const HuffmanTable& distances, BitWriter& writer) {
+	auto& lengthSymbols = getLengthSymbols();
+	auto distanceSymbol = distance - 1;
+	scanSymbols(filtered, distance, [&](Uint8 value) {
+		writer.write(literals.codes[value], literals.lengths[value]);
+	}, [&](int length) {
+		auto symbol = lengthSymbols[length];
+		writer.write(literals.codes[257 + symbol], literals.lengths[257 + symbol]);
+		if (lengthExtra[symbol] > 0) writer.write(length - lengthBase[symbol], lengthExtra[symbol]);
+		writer.write(distances.codes[distanceSymbol], distances.lengths[distanceSymbol]);
+	});
+}
+
+void Png::buildLengths(const Uint32* frequencies, int count, int limit, Uint8* lengths) {
+	std::fill(lengths, lengths + count, 0);
+	std::vector<int> symbols;
+	for (auto i = 0; i < count; ++i) if (frequencies[i] > 0) symbols.push_back(i);
+	if (symbols.empty()) return;
+	if (symbols.size() == 1) {
+		lengths[symbols[0]] = 1;
+		return;
+	}
+
+	struct Node {
+		Uint64 weight;
+		int left;
+		int right;
+	};
+	std::vector<Node> nodes;
+	using Entry = std::pair<Uint64, int>;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<>> queue;
+	for (auto symbol : symbols) {
+		queue.emplace(frequencies[symbol], (int)nodes.size());
+		nodes.push_back({ frequencies[symbol], -1, -1 });
+	}
+	while (queue.size() > 1) {
+		auto first = queue.top();
+		queue.pop();
+		auto second = queue.top();
+		queue.pop();
+		queue.emplace(first.first + second.first, (int)nodes.size());
+		nodes.push_back({ first.first + second.first, first.second, second.second });
+	}
+
+	std::vector<int> lengthCounts(limit + 1, 0);
+	std::vector<std::pair<int, int>> stack = { { queue.top().second, 0 } };
+	while (!stack.empty()) {
+		auto [node, depth] = stack.back();
+		stack.pop_back();
+		if (nodes[node].left < 0) {
+			++lengthCounts[std::min(depth, limit)];
+			continue;
+		}
+		stack.emplace_back(nodes[node].left, depth + 1);
+		stack.emplace_back(nodes[node].right, depth + 1);
+	}
+
+	Uint32 total = 0;
+	for (auto i = 1; i <= limit; ++i) total += (Uint32)lengthCounts[i] << (limit - i);
+	while (total > (1u << limit)) {
+		--lengthCounts[limit];
+		for (auto i = limit - 1; i > 0; --i) {
+			if (lengthCounts[i] > 0) {
+				--lengthCounts[i];
+				lengthCounts[i + 1] += 2;
+				break;
+			}
+		}
+		--total;
+	}
+
+	std::stable_sort(symbols.begin(), symbols.end(), [&](int a, int b) {
+		return frequencies[a] > frequencies[b];
+	});
+	auto index = 0;
+	for (auto length = 1; length <= limit; ++length) {
+		for (auto i = 0; i < lengthCounts[length]; ++i) lengths[symbols[index++]] = (Uint8)length;
+	}
+}
+
+void Png::buildCodes(const Uint8* lengths, int count, Uint16* codes) {
+	int lengthCounts[16] = {};
+	for (auto i = 0; i < count; ++i) ++lengthCounts[lengths[i]];
+	lengthCounts[0] = 0;
+	int nextCode[16] = {};
+	for (auto length = 1, code = 0; length < 16; ++length) {
+		code = (code + lengthCounts[length - 1]) << 1;
+		nextCode[length] = code;
+	}
+	for (auto i = 0; i < count; ++i) {
+		auto length = lengths[i];
+		if (length == 0) continue;
+		auto code = nextCode[length]++;
+		Uint16 reversed = 0;
+		for (auto bit = 0; bit < length; ++bit) reversed |= (Uint16)(((code >> bit) & 1) << (length - 1 - bit));
+		codes[i] = reversed;
+	}
+}
+
+void Png::writeTables(const HuffmanTable& literals, const HuffmanTable& distances, BitWriter& writer) {
+	auto literalCount = 286;
+	while (literalCount > 257 && literals.lengths[literalCount - 1] == 0) --literalCount;
+	auto distanceCount = 30;
+	while (distanceCount > 1 && distances.lengths[distanceCount - 1] == 0) --distanceCount;
+
+	std::vector<Uint8> lengths(literals.lengths, literals.lengths + literalCount);
+	lengths.insert(lengths.end(), distances.lengths, distances.lengths + distanceCount);
+
+	struct Token {
+		Uint8 symbol;
+		Uint8 extra;
+		Uint8 extraBits;
+	};
+	std::vector<Token> tokens;
+	for (size_t i = 0; i < lengths.size();) {
+		auto value = lengths[i];
+		size_t run = 1;
+		while (i + run < lengths.size() && lengths[i + run] == value) ++run;
+		i += run;
+		if (value == 0) {
+			while (run >= 11) {
+				auto repeat = std::min<size_t>(run, 138);
+				tokens.push_back({ 18, (Uint8)(repeat - 11), 7 });
+				run -= repeat;
+			}
+			if (run >= 3) {
+				tokens.push_back({ 17, (Uint8)(run - 3), 3 });
+				run = 0;
+			}
+		} else {
+			tokens.push_back({ value, 0, 0 });
+			--run;
+			while (run >= 3) {
+				auto repeat = std::min<size_t>(run, 6);
+				tokens.push_back({ 16, (Uint8)(repeat - 3), 2 });
+				run -= repeat;
+			}
+		}
+		for (; run > 0; --run) tokens.push_back({ value, 0, 0 });
+	}
+
+	Uint32 frequencies[19] = {};
+	for (const auto& token : tokens) ++frequencies[token.symbol];
+	Uint8 codeLengths[19];
+	Uint16 codes[19] = {};
+	buildLengths(frequencies, 19, 7, codeLengths);
+	buildCodes(codeLengths, 19, codes);
+	auto orderCount = 19;
+	while (orderCount > 4 && codeLengths[codeLengthOrder[orderCount - 1]] == 0) --orderCount;
+
+	writer.write(literalCount - 257, 5);
+	writer.write(distanceCount - 1, 5);
+	writer.write(orderCount - 4, 4);
+	for (auto i = 0; i < orderCount; ++i) writer.write(codeLengths[codeLengthOrder[i]], 3);
+	for (const auto& token : tokens) {
+		writer.write(codes[token.symbol], codeLengths[token.symbol]);
+		if (token.extraBits > 0) writer.write(token.extra, token.extraBits);
+	}
+}
+
+void Png::buildTables(Uint32* literalCounts, Uint32* distanceCounts, HuffmanTable& literals,
+	HuffmanTable& distances) {
+	literalCounts[256] = std::max(literalCounts[256], 1u);
+	if (std::all_of(distanceCounts, distanceCounts + 30, [](Uint32 count) { return count == 0; }))
+		distanceCounts[0] = 1;
+	buildLengths(literalCounts, 286, 15, literals.lengths);
+	buildCodes(literals.lengths, 286, literals.codes);
+	buildLengths(distanceCounts, 30, 15, distances.lengths);
+	buildCodes(distances.lengths, 30, distances.codes);
+}
+
+void Png::writeGroup(const std::vector<Uint8>& filtered, const HuffmanTable& literals,
+	const HuffmanTable& distances, bool last, BitWriter& writer) {
+	writer.data.reserve(filtered.size() / 2 + 64);
+	writer.write(last ? 1 : 0, 1);
+	writer.write(2, 2);
+	writeTables(literals, distances, writer);
+	writeSymbols(filtered, 3, literals, distances, writer);
+	writer.write(literals.codes[256], literals.lengths[256]);
+	if (!last) {
+		writer.write(0, 3);
+		writer.align();
+		writer.data.insert(writer.data.end(), { 0x00, 0x00, 0xFF, 0xFF });
+	} else {
+		writer.align();
+	}
+}
+
+Uint32 Png::getAdler(const Uint8* data, size_t size) {
+	Uint32 first = 1, second = 0;
+	while (size > 0) {
+		auto block = std::min<size_t>(size, 5552);
+		size -= block;
+		for (size_t i = 0; i < block; ++i) {
+			first += data[i];
+			second += first;
+		}
+		data += block;
+		first %= 65521;
+		second %= 65521;
+	}
+	return second << 16 | first;
+}
+
+Uint32 Png::combineAdler(Uint32 first, Uint32 second, size_t secondSize) {
+	const Uint32 base = 65521;
+	auto remainder = (Uint32)(secondSize % base);
+	auto sum1 = first & 0xFFFF;
+	auto sum2 = (Uint32)(((Uint64)remainder * sum1) % base);
+	sum1 += (second & 0xFFFF) + base - 1;
+	sum2 += ((first >> 16) & 0xFFFF) + ((second >> 16) & 0xFFFF) + base - remainder;
+	if (sum1 >= base) sum1 -= base;
+	if (sum1 >= base) sum1 -= base;
+	if (sum2 >= base << 1) sum2 -= base << 1;
+	if (sum2 >= base) sum2 -= base;
+	return sum2 << 16 | sum1;
+}
+
+Uint32 Png::getCrc(const Uint8* data, size_t size, Uint32 crc) {
+	static const auto table = [] {
+		std::array<Uint32, 256> result{};
+		for (Uint32 i = 0; i < 256; ++i) {
+			auto value = i;
+			for (auto bit = 0; bit < 8; ++bit) value = value & 1 ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+			result[i] = value;
+		}
+		return result;
+	}();
+	crc = ~crc;
+	for (size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+void Png::writeChunk(std::vector<Uint8>& output, const char* type, const Uint8* data, size_t size) {
+	writeBigEndian(output, (Uint32)size);
+	auto start = output.size();
+	output.insert(output.end(), type, type + 4);
+	if (size > 0) output.insert(output.end(), data, data + size);
+	writeBigEndian(output, getCrc(output.data() + start, output.size() - start));
+}
+
+int Png::begin(Stream& stream, int width, int height, int groupRows) {
+	if (width <= 0 || height <= 0 || groupRows <= 0) return -1;
+	auto groupCount = (height + groupRows - 1) / groupRows;
+	stream.width = width;
+	stream.height = height;
+	stream.groupRows = groupRows;
+	stream.groups.assign(groupCount, {});
+	stream.adlers.assign(groupCount, 1);
+	stream.sizes.assign(groupCount, 0);
+	return 0;
+}
+
+int Png::encodeRows(Stream& stream, const SDL_Surface* surface, int firstRow, int group) {
+	auto groupCount = (int)stream.groups.size();
+	if (surface == nullptr || surface->w != stream.width || group < 0 || group >= groupCount) return -1;
+	auto rows = std::min(stream.groupRows, stream.height - group * stream.groupRows);
+	auto above = group > 0;
+	if (firstRow < (above ? 1 : 0) || firstRow + rows > surface->h) return -1;
+	int channels[3];
+	SDL_Surface* converted;
+	if (getChannels(surface, channels, converted) != 0) return -1;
+	auto source = converted ? converted : surface;
+
+	std::vector<Uint8> filtered;
+	filterGroup(static_cast<const Uint8*>(source->pixels) + (size_t)firstRow * source->pitch, source->pitch,
+		stream.width, rows, above, channels, filtered);
+	SDL_DestroySurface(converted);
+	Uint32 literalCounts[286] = {};
+	Uint32 distanceCounts[30] = {};
+	countSymbols(filtered, 3, literalCounts, distanceCounts);
+	HuffmanTable literals{}, distances{};
+	buildTables(literalCounts, distanceCounts, literals, distances);
+	BitWriter writer;
+	writeGroup(filtered, literals, distances, group == groupCount - 1, writer);
+	stream.groups[group] = std::move(writer.data);
+	stream.adlers[group] = getAdler(filtered.data(), filtered.size());
+	stream.sizes[group] = filtered.size();
+	return 0;
+}
+
+void Png::finish(Stream& stream, std::vector<Uint8>& output) {
+	auto groupCount = (int)stream.groups.size();
+	auto adler = 1u;
+	size_t totalSize = 64;
+	for (auto group = 0; group < groupCount; ++group) {
+		adler = combineAdler(adler, stream.adlers[group], stream.sizes[group]);
+		totalSize += stream.groups[group].size() + 12;
+	}
+	stream.groups.front().insert(stream.groups.front().begin(), { 0x78, 0x01 });
+	writeBigEndian(stream.groups.back(), adler);
+
+	output.clear();
+	output.reserve(totalSize + 6);
+	output.insert(output.end(), { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A });
+	std::vector<Uint8> header;
+	writeBigEndian(header, (Uint32)stream.width);
+	writeBigEndian(header, (Uint32)stream.height);
+	header.insert(header.end(), { 8, 2, 0, 0, 0 });
+	writeChunk(output, "IHDR", header.data(), header.size());
+	for (auto& group : stream.groups) {
+		writeChunk(output, "IDAT", group.data(), group.size());
+		std::vector<Uint8>().swap(group);
+	}
+	writeChunk(output, "IEND", nullptr, 0);
+}
+
+int Png::encode(const SDL_Surface* surface, std::vector<Uint8>& output) {
+	if (surface == nullptr || surface->w <= 0 || surface->h <= 0) return -1;
+	int channels[3];
+	SDL_Surface* converted;
+	if (getChannels(surface, channels, converted) != 0) return -1;
+	auto source = converted ? converted : surface;
+
+	auto threadCount = encodeThreads > 0 ? encodeThreads : (int)std::thread::hardware_concurrency();
+	threadCount = std::max(threadCount, 1);
+	auto rowsPerGroup = groupRows > 0 ? groupRows :
+		std::max((source->h + threadCount * groupsPerThread - 1) / (threadCount * groupsPerThread), minimumGroupRows);
+	Stream stream{};
+	begin(stream, source->w, source->h, rowsPerGroup);
+	auto groupCount = (int)stream.groups.size();
+
+	std::vector<std::vector<Uint8>> filtered(groupCount);
+	std::vector<std::array<Uint32, 286>> literalCounts(groupCount);
+	std::vector<std::array<Uint32, 30>> distanceCounts(groupCount);
+	runParallel(groupCount, threadCount, [&](int group) {
+		auto firstRow = group * rowsPerGroup;
+		filterGroup(static_cast<const Uint8*>(source->pixels) + (size_t)firstRow * source->pitch, source->pitch,
+			source->w, std::min(rowsPerGroup, source->h - firstRow), group > 0, channels, filtered[group]);
+		literalCounts[group].fill(0);
+		distanceCounts[group].fill(0);
+		countSymbols(filtered[group], 3, literalCounts[group].data(), distanceCounts[group].data());
+		stream.adlers[group] = getAdler(filtered[group].data(), filtered[group].size());
+		stream.sizes[group] = filtered[group].size();
+	});
+	SDL_DestroySurface(converted);
+
+	Uint32 literalTotals[286] = {};
+	Uint32 distanceTotals[30] = {};
+	for (auto group = 0; group < groupCount; ++group) {
+		for (auto i = 0; i < 286; ++i) literalTotals[i] += literalCounts[group][i];
+		for (auto i = 0; i < 30; ++i) distanceTotals[i] += distanceCounts[group][i];
+	}
+	HuffmanTable literals{}, distances{};
+	buildTables(literalTotals, distanceTotals, literals, distances);
+
+	runParallel(groupCount, threadCount, [&](int group) {
+		BitWriter writer;
+		writeGroup(filtered[group], literals, distances, group == groupCount - 1, writer);
+		std::vector<Uint8>().swap(filtered[group]);
+		stream.groups[group] = std::move(writer.data);
+	});
+	finish(stream, output);
+	return 0;
+}
+
+int Png::save(const SDL_Surface* surface, const std::filesystem::path& path) {
+	std::vector<Uint8> output;
+	if (encode(surface, output) != 0) return -1;
+	auto file = SDL_IOFromFile(path.string().c_str(), "wb");
+	if (file == nullptr) return -1;
+	auto written = SDL_WriteIO(file, output.data(), output.size());
+	auto closed = SDL_CloseIO(file);
+	return written == output.size() && closed ? 0 : -1;
+}
\ No newline at end of file
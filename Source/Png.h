@@ -0,0 +1,81 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RENDEPTH_PNG_H
+#define RENDEPTH_PNG_H
+
+#include <SDL3/SDL.h>
+#include <filesystem>
+#include <vector>
+
+class Png {
+public:
+	struct Stream {
+		int width;
+		int height;
+		int groupRows;
+		std::vector<std::vector<Uint8>> groups;
+		std::vector<Uint32> adlers;
+		std::vector<size_t> sizes;
+	};
+
+	static int encode(const SDL_Surface* surface, std::vector<Uint8>& output);
+	static int save(const SDL_Surface* surface, const std::filesystem::path& path);
+	static int begin(Stream& stream, int width, int height, int groupRows);
+	static int encodeRows(Stream& stream, const SDL_Surface* surface, int firstRow, int group);
+	static void finish(Stream& stream, std::vector<Uint8>& output);
+	inline static int encodeThreads = 0;
+	inline static int groupRows = 0;
+	inline static int groupsPerThread = 4;
+	inline static int minimumGroupRows = 16;
+private:
+	struct BitWriter {
+		std::vector<Uint8> data;
+		Uint64 buffer = 0;
+		int count = 0;
+		void write(Uint32 bits, int size);
+		void align();
+	};
+
+	struct HuffmanTable {
+		Uint16 codes[288];
+		Uint8 lengths[288];
+	};
+
+	static int getChannels(const SDL_Surface* surface, int channels[3], SDL_Surface*& converted);
+	static void filterGroup(const Uint8* pixels, int pitch, int width, int rows, bool above, const int channels[3],
+		std::vector<Uint8>& filtered);
+	static void countSymbols(const std::vector<Uint8>& filtered, int distance, Uint32* literals, Uint32* distances);
+	static void writeSymbols(const std::vector<Uint8>& filtered, int distance, const HuffmanTable& literals,
+		const HuffmanTable& distances, BitWriter& writer);
+	static void buildLengths(const Uint32* frequencies, int count, int limit, Uint8* lengths);
+	static void buildCodes(const Uint8* lengths, int count, Uint16* codes);
+	static void writeTables(const HuffmanTable& literals, const HuffmanTable& distances, BitWriter& writer);
+	static void buildTables(Uint32* literalCounts, Uint32* distanceCounts, HuffmanTable& literals,
+		HuffmanTable& distances);
+	static void writeGroup(const std::vector<Uint8>& filtered, const HuffmanTable& literals,
+		const HuffmanTable& distances, bool last, BitWriter& writer);
+	static Uint32 getAdler(const Uint8* data, size_t size);
+	static Uint32 combineAdler(Uint32 first, Uint32 second, size_t secondSize);
+	static Uint32 getCrc(const Uint8* data, size_t size, Uint32 crc = 0);
+	static void writeChunk(std::vector<Uint8>& output, const char* type, const Uint8* data, size_t size);
+};
+
+#endif
\ No newline at end of file
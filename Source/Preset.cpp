@@ -0,0 +1,230 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Preset.h"
+#include "Depth.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+static const char* backgroundNames[4] = { "blur", "solid", "light", "dark" };
+static const BackgroundStyle backgroundStyles[4] = { Blur, Solid, Light, Dark };
+
+bool Preset::parse(rapidjson::Value& value, ExportPreset& preset, std::string& error) {
+	auto getString = [&](const char* name, std::string& field) {
+		if (value.HasMember(name) && value[name].IsString()) field = value[name].GetString();
+	};
+	auto getInt = [&](const char* name, int& field) {
+		if (value.HasMember(name) && value[name].IsInt()) field = value[name].GetInt();
+	};
+	auto getFloat = [&](const char* name, float& field) {
+		if (value.HasMember(name) && value[name].IsNumber()) field = (float)value[name].GetDouble();
+	};
+	std::string encoding = preset.encoding == Encoding_Png ? "png" : "jpeg", background;
+	getString("name", preset.name);
+	getString("format", preset.format);
+	getString("encoding", encoding);
+	getString("background", background);
+	getInt("quality", preset.quality);
+	getInt("width", preset.width);
+	getInt("height", preset.height);
+	getFloat("strength", preset.parameters.strength);
+	getFloat("depth", preset.parameters.depth);
+	getFloat("offset", preset.parameters.offset);
+	if (value.HasMember("swap") && value["swap"].IsBool()) preset.parameters.swapLeftRight = value["swap"].GetBool();
+
+	if (encoding != "jpeg" && encoding != "png") error = "Unknown Encoding: " + encoding;
+	else if (preset.width < 0 || preset.height < 0 || preset.width > Image::maxImageSize ||
+		preset.height > Image::maxImageSize) error = "Invalid Size";
+	preset.encoding = encoding == "png" ? Encoding_Png : Encoding_Jpeg;
+	preset.quality = std::clamp(preset.quality, 1, 100);
+	if (!background.empty()) {
+		auto found = std::find(std::begin(backgroundNames), std::end(backgroundNames), background);
+		if (found == std::end(backgroundNames)) error = "Unknown Background: " + background;
+		else preset.background = backgroundStyles[found - std::begin(backgroundNames)];
+	}
+	return error.empty();
+}
+
+int Preset::load(const std::filesystem::path& path, ExportPreset& preset) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		SDL_Log("Could Not Open Preset: %s.", path.string().c_str());
+		return -1;
+	}
+	std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	rapidjson::Document document;
+	if (document.Parse(text.c_str()).HasParseError() || !document.IsObject()) {
+		SDL_Log("Invalid Preset: %s.", path.string().c_str());
+		return -1;
+	}
+	preset = ExportPreset{};
+	preset.name = path.stem().string();
+	std::string error;
+	if (!parse(document, preset, error)) {
+		SDL_Log("Invalid Preset %s: %s.", path.filename().string().c_str(), error.c_str());
+		return -1;
+	}
+	if (preset.name.empty() || preset.name.find_first_of("/\\:") != std::string::npos) {
+		SDL_Log("Invalid Preset %s: Bad Name \"%s\".", path.filename().string().c_str(), preset.name.c_str());
+		return -1;
+	}
+	return 0;
+}
+
+int Preset::loadPresets(const std::vector<std::string>& paths, std::vector<ExportPreset>& presets) {
+	auto result = 0;
+	for (const auto& path : paths) {
+		std::vector<std::filesystem::path> files;
+		if (std::filesystem::is_directory(path)) {
+			for (const auto& entry : std::filesystem::directory_iterator(path)) {
+				if (entry.path().extension() == ".json") files.push_back(entry.path());
+			}
+			std::sort(files.begin(), files.end());
+		} else {
+			files.emplace_back(path);
+		}
+		for (const auto& file : files) {
+			ExportPreset preset;
+			if (load(file, preset) != 0) {
+				result = -1;
+				continue;
+			}
+			auto found = std::find_if(presets.begin(), presets.end(),
+				[&](const ExportPreset& loaded) { return loaded.name == preset.name; });
+			if (found != presets.end()) {
+				SDL_Log("Invalid Preset %s: Duplicate Name \"%s\".", file.filename().string().c_str(),
+					preset.name.c_str());
+				result = -1;
+				continue;
+			}
+			presets.push_back(preset);
+		}
+	}
+	return result;
+}
+
+bool Preset::canRender(const ExportPreset& preset) {
+	if (preset.format == "rgbd") return true;
+	return Render::getMode(preset.format) != Native && preset.background != Blur;
+}
+
+SDL_Color Preset::getBackground(const SDL_Surface* colorDepth, BackgroundStyle background) {
+	auto color = background == Light ? Image::clearColorLight : Image::clearColorDark;
+	if (background == Solid) {
+		color = Image::getBackgroundColor(const_cast<SDL_Surface*>(colorDepth), 4, colorDepth->w / 2, colorDepth->h);
+	}
+	return { (Uint8)std::lround(color.r * 255.0f), (Uint8)std::lround(color.g * 255.0f),
+		(Uint8)std::lround(color.b * 255.0f), 255 };
+}
+
+SDL_Surface* Preset::render(const SDL_Surface* colorDepth, const ExportPreset& preset) {
+	if (colorDepth == nullptr || !canRender(preset)) return nullptr;
+	if (preset.format == "rgbd") return SDL_DuplicateSurface(const_cast<SDL_Surface*>(colorDepth));
+	auto mode = Render::getMode(preset.format);
+	auto size = Render::getDisplaySize(mode, colorDepth);
+	auto width = preset.width > 0 ? preset.width : size.x;
+	auto height = preset.height > 0 ? preset.height : size.y;
+	auto output = SDL_CreateSurface(width, height, SDL_PIXELFORMAT_ABGR8888);
+	if (output != nullptr && Render::renderDisplay(colorDepth, preset.parameters, mode, output,
+		getBackground(colorDepth, preset.background)) != 0) {
+		SDL_DestroySurface(output);
+		return nullptr;
+	}
+	return output;
+}
+
+int Preset::encode(const SDL_Surface* surface, const ExportPreset& preset, std::vector<Uint8>& output) {
+	if (preset.encoding == Encoding_Png) return Png::encode(surface, output);
+	return Jpeg::encode(surface, preset.quality, output);
+}
+
+void Preset::shareThreads(int workers) {
+	auto threads = std::max((int)std::thread::hardware_concurrency() / std::max(workers, 1), 1);
+	if (Render::renderThreads == 0) Render::renderThreads = threads;
+	if (Jpeg::encodeThreads == 0) Jpeg::encodeThreads = threads;
+	if (Png::encodeThreads == 0) Png::encodeThreads = threads;
+	if (Depth::upsampleThreads == 0) Depth::upsampleThreads = threads;
+}
+
+int Preset::writeFile(const std::filesystem::path& path, const std::vector<Uint8>& data) {
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file) return -1;
+	file.write(reinterpret_cast<const char*>(data.data()), (std::streamsize)data.size());
+	return file ? 0 : -1;
+}
+
+int Preset::exportBatch(const std::vector<std::filesystem::path>& files, const std::vector<ExportPreset>& presets,
+	const std::function<SDL_Surface*(const std::filesystem::path&)>& loadColorDepth) {
+	std::vector<const ExportPreset*> renderable;
+	for (const auto& preset : presets) {
+		if (canRender(preset)) renderable.push_back(&preset);
+		else if (Render::getMode(preset.format) != Native)
+			SDL_Log("Preset %s Needs --export for Blur Background.", preset.name.c_str());
+		else SDL_Log("Preset %s Needs --export for Format: %s.", preset.name.c_str(), preset.format.c_str());
+	}
+	if (renderable.empty() || files.empty()) return -1;
+
+	auto threadCount = presetThreads > 0 ? presetThreads : (int)std::thread::hardware_concurrency();
+	threadCount = std::clamp(threadCount, 1, (int)renderable.size());
+	shareThreads(threadCount);
+	if (!outputFolder.empty()) {
+		std::error_code error;
+		std::filesystem::create_directories(outputFolder, error);
+	}
+
+	std::atomic<int> failures = renderable.size() < presets.size() ? 1 : 0;
+	for (const auto& file : files) {
+		auto colorDepth = loadColorDepth(file);
+		if (colorDepth == nullptr) {
+			SDL_Log("Preset Export Skipped: %s.", file.filename().string().c_str());
+			++failures;
+			continue;
+		}
+		auto folder = outputFolder.empty() ? file.parent_path() : outputFolder;
+		auto outFileName = Core::removeFileTags(file.stem().string());
+		std::atomic<int> next = 0;
+		auto work = [&]() {
+			for (auto index = next++; index < (int)renderable.size(); index = next++) {
+				const auto& preset = *renderable[index];
+				auto extension = preset.encoding == Encoding_Png ? ".png" : ".jpg";
+				auto outFilePath = folder / (outFileName + "_" + preset.name + extension);
+				auto output = render(colorDepth, preset);
+				std::vector<Uint8> data;
+				if (output == nullptr || encode(output, preset, data) != 0 || writeFile(outFilePath, data) != 0) {
+					SDL_Log("Preset Export Failed: %s.", outFilePath.filename().string().c_str());
+					++failures;
+				} else {
+					SDL_Log("Preset Export Saved: %s.", outFilePath.filename().string().c_str());
+				}
+				SDL_DestroySurface(output);
+			}
+		};
+		std::vector<std::thread> threads;
+		for (auto i = 1; i < threadCount; ++i) threads.emplace_back(work);
+		work();
+		for (auto& thread : threads) thread.join();
+		SDL_DestroySurface(colorDepth);
+	}
+	return failures == 0 ? 0 : -1;
+}
\ No newline at end of file
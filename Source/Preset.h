@@ -0,0 +1,51 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RENDEPTH_PRESET_H
+#define RENDEPTH_PRESET_H
+
+#include "Export.h"
+#include "Render.h"
+#include "rapidjson/document.h"
+#include <SDL3/SDL.h>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+class Preset {
+public:
+	static bool parse(rapidjson::Value& value, ExportPreset& preset, std::string& error);
+	static int load(const std::filesystem::path& path, ExportPreset& preset);
+	static int loadPresets(const std::vector<std::string>& paths, std::vector<ExportPreset>& presets);
+	static bool canRender(const ExportPreset& preset);
+	static SDL_Surface* render(const SDL_Surface* colorDepth, const ExportPreset& preset);
+	static int encode(const SDL_Surface* surface, const ExportPreset& preset, std::vector<Uint8>& output);
+	static void shareThreads(int workers);
+	static int exportBatch(const std::vector<std::filesystem::path>& files, const std::vector<ExportPreset>& presets,
+		const std::function<SDL_Surface*(const std::filesystem::path&)>& loadColorDepth);
+	inline static std::filesystem::path outputFolder;
+	inline static int presetThreads = 0;
+private:
+	static SDL_Color getBackground(const SDL_Surface* colorDepth, BackgroundStyle background);
+	static int writeFile(const std::filesystem::path& path, const std::vector<Uint8>& data);
+};
+
+#endif
\ No newline at end of file
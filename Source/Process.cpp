@@ -0,0 +1,252 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Process.h"
+#include <algorithm>
+#include <array>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+extern char** environ;
+#endif
+
+#ifdef _WIN32
+static std::string quoteArgument(const std::string& argument) {
+	if (!argument.empty() && argument.find_first_of(" \t\"") == std::string::npos) return argument;
+	std::string quoted = "\"";
+	auto slashes = 0;
+	for (auto character : argument) {
+		if (character == '\\') {
+			++slashes;
+			continue;
+		}
+		if (character == '"') quoted.append(slashes * 2 + 1, '\\');
+		else quoted.append(slashes, '\\');
+		slashes = 0;
+		quoted += character;
+	}
+	quoted.append(slashes * 2, '\\');
+	return quoted + "\"";
+}
+#endif
+
+int Process::spawn(ProcessHandle& handle, const std::string& program, const std::vector<std::string>& arguments,
+	ProcessOutput output, const std::string& outputPath, bool detached) {
+	release(handle);
+	reap();
+#ifdef _WIN32
+	auto commandLine = quoteArgument(program);
+	for (const auto& argument : arguments) commandLine += " " + quoteArgument(argument);
+
+	SECURITY_ATTRIBUTES security = { sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
+	HANDLE readPipe = nullptr, writeHandle = nullptr;
+	if (output == Output_Pipe) {
+		if (!CreatePipe(&readPipe, &writeHandle, &security, 0)) return -1;
+		SetHandleInformation(readPipe, HANDLE_FLAG_INHERIT, 0);
+	} else if (output == Output_File) {
+		writeHandle = CreateFileA(outputPath.c_str(), GENERIC_WRITE, FILE_SHARE_READ, &security,
+			CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (writeHandle == INVALID_HANDLE_VALUE) return -1;
+	}
+
+	STARTUPINFOA startup{};
+	startup.cb = sizeof(startup);
+	if (writeHandle) {
+		startup.dwFlags = STARTF_USESTDHANDLES;
+		startup.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+		startup.hStdOutput = writeHandle;
+		startup.hStdError = writeHandle;
+	}
+	DWORD flags = CREATE_NO_WINDOW;
+	if (detached) flags |= CREATE_NEW_PROCESS_GROUP;
+	PROCESS_INFORMATION information{};
+	auto created = CreateProcessA(nullptr, commandLine.data(), nullptr, nullptr, writeHandle != nullptr,
+		flags, nullptr, nullptr, &startup, &information);
+	if (writeHandle) CloseHandle(writeHandle);
+	if (!created) {
+		if (readPipe) CloseHandle(readPipe);
+		return -1;
+	}
+	CloseHandle(information.hThread);
+	handle.process = information.hProcess;
+	handle.output = readPipe;
+#else
+	std::vector<char*> argv;
+	argv.push_back(const_cast<char*>(program.c_str()));
+	for (const auto& argument : arguments) argv.push_back(const_cast<char*>(argument.c_str()));
+	argv.push_back(nullptr);
+
+	std::array<int, 2> pipeDescriptors = { -1, -1 };
+	posix_spawn_file_actions_t actions;
+	posix_spawn_file_actions_init(&actions);
+	posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+	if (output == Output_Pipe) {
+		if (pipe(pipeDescriptors.data()) != 0) {
+			posix_spawn_file_actions_destroy(&actions);
+			return -1;
+		}
+		fcntl(pipeDescriptors[0], F_SETFD, FD_CLOEXEC);
+		posix_spawn_file_actions_adddup2(&actions, pipeDescriptors[1], STDOUT_FILENO);
+		posix_spawn_file_actions_adddup2(&actions, pipeDescriptors[1], STDERR_FILENO);
+		posix_spawn_file_actions_addclose(&actions, pipeDescriptors[1]);
+	} else if (output == Output_File) {
+		posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, outputPath.c_str(),
+			O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+	}
+
+	posix_spawnattr_t attributes;
+	posix_spawnattr_init(&attributes);
+#ifdef POSIX_SPAWN_SETSID
+	if (detached) posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSID);
+#endif
+	pid_t processId = -1;
+	auto result = posix_spawn(&processId, program.c_str(), &actions, &attributes, argv.data(), environ);
+	posix_spawnattr_destroy(&attributes);
+	posix_spawn_file_actions_destroy(&actions);
+	if (pipeDescriptors[1] >= 0) ::close(pipeDescriptors[1]);
+	if (result != 0) {
+		if (pipeDescriptors[0] >= 0) ::close(pipeDescriptors[0]);
+		return -1;
+	}
+	if (pipeDescriptors[0] >= 0) fcntl(pipeDescriptors[0], F_SETFL, O_NONBLOCK);
+	handle.id = processId;
+	handle.output = pipeDescriptors[0];
+#endif
+	return 0;
+}
+
+bool Process::isValid(const ProcessHandle& handle) {
+#ifdef _WIN32
+	return handle.process != nullptr;
+#else
+	return handle.id > 0;
+#endif
+}
+
+bool Process::isRunning(ProcessHandle& handle, int* exitCode) {
+	if (!isValid(handle)) return false;
+#ifdef _WIN32
+	if (WaitForSingleObject(handle.process, 0) == WAIT_TIMEOUT) return true;
+	DWORD code = 0;
+	GetExitCodeProcess(handle.process, &code);
+	if (exitCode) *exitCode = (int)code;
+	CloseHandle(handle.process);
+	handle.process = nullptr;
+#else
+	auto status = 0;
+	auto result = waitpid(handle.id, &status, WNOHANG);
+	if (result == 0) return true;
+	if (exitCode) *exitCode = result > 0 && WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+	handle.id = -1;
+#endif
+	return false;
+}
+
+int Process::wait(ProcessHandle& handle, Uint32 timeout) {
+	auto exitCode = 0;
+	if (timeout == 0 && isValid(handle)) {
+#ifdef _WIN32
+		WaitForSingleObject(handle.process, INFINITE);
+#else
+		auto status = 0;
+		while (waitpid(handle.id, &status, 0) < 0 && errno == EINTR) {}
+		handle.id = -1;
+		return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+	}
+	auto start = SDL_GetTicks();
+	while (isRunning(handle, &exitCode)) {
+		if (SDL_GetTicks() - start >= timeout) return -1;
+		SDL_Delay(5);
+	}
+	return exitCode;
+}
+
+int Process::readLines(ProcessHandle& handle, std::vector<std::string>& lines) {
+	std::array<char, 4096> buffer{};
+	auto received = 0;
+	while (true) {
+#ifdef _WIN32
+		if (!handle.output) return -1;
+		DWORD available = 0;
+		if (!PeekNamedPipe(handle.output, nullptr, 0, nullptr, &available, nullptr)) {
+			CloseHandle(handle.output);
+			handle.output = nullptr;
+			break;
+		}
+		if (available == 0) break;
+		DWORD count = 0;
+		if (!ReadFile(handle.output, buffer.data(), (DWORD)std::min<size_t>(available, buffer.size()),
+			&count, nullptr) || count == 0) break;
+#else
+		if (handle.output < 0) return -1;
+		auto count = read(handle.output, buffer.data(), buffer.size());
+		if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) break;
+		if (count <= 0) {
+			::close(handle.output);
+			handle.output = -1;
+			break;
+		}
+#endif
+		handle.pending.append(buffer.data(), (size_t)count);
+		received += (int)count;
+	}
+
+	size_t lineEnd;
+	while ((lineEnd = handle.pending.find('\n')) != std::string::npos) {
+		auto line = handle.pending.substr(0, lineEnd);
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		lines.push_back(line);
+		handle.pending.erase(0, lineEnd + 1);
+	}
+	return received;
+}
+
+void Process::release(ProcessHandle& handle) {
+#ifdef _WIN32
+	if (handle.output) CloseHandle(handle.output);
+	if (handle.process) CloseHandle(handle.process);
+	handle.output = nullptr;
+	handle.process = nullptr;
+#else
+	if (handle.output >= 0) ::close(handle.output);
+	if (handle.id > 0 && waitpid(handle.id, nullptr, WNOHANG) == 0) {
+		std::lock_guard lock(releasedMutex);
+		releasedIds.push_back(handle.id);
+	}
+	handle.output = -1;
+	handle.id = -1;
+#endif
+	handle.pending.clear();
+}
+
+void Process::reap() {
+#ifndef _WIN32
+	std::lock_guard lock(releasedMutex);
+	std::erase_if(releasedIds, [](int processId) { return waitpid(processId, nullptr, WNOHANG) != 0; });
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RENDEPTH_PROCESS_H
+#define RENDEPTH_PROCESS_H
+
+#include <SDL3/SDL.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum ProcessOutput {
+	Output_Inherit = 0,
+	Output_Pipe = 1,
+	Output_File = 2
+};
+
+struct ProcessHandle {
+#ifdef _WIN32
+	void* process = nullptr;
+	void* output = nullptr;
+#else
+	int id = -1;
+	int output = -1;
+#endif
+	std::string pending;
+};
+
+class Process {
+public:
+	static int spawn(ProcessHandle& handle, const std::string& program, const std::vector<std::string>& arguments,
+		ProcessOutput output = Output_Inherit, const std::string& outputPath = "", bool detached = false);
+	static bool isRunning(ProcessHandle& handle, int* exitCode = nullptr);
+	static int wait(ProcessHandle& handle, Uint32 timeout);
+	static int readLines(ProcessHandle& handle, std::vector<std::string>& lines);
+	static void release(ProcessHandle& handle);
+	static void reap();
+	static bool isValid(const ProcessHandle& handle);
+private:
+	inline static std::mutex releasedMutex;
+	inline static std::vector<int> releasedIds;
+};
+
+#endif
\ No newline at end of file
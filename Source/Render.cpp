@@ -0,0 +1,347 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Render.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <thread>
+#include <vector>
+#ifdef __AVX__
+#include <immintrin.h>
+#endif
+
+static const float stereoScale = 50000.0f;
+static const float zNear = 0.1f;
+static const float zFar = 100.0f;
+static const float depthSamples[5] = { 0.125f, 0.250f, 0.375f, 0.500f, 0.625f };
+static const float uvGutter = 0.001f;
+static const float edgeStretch = 0.333f;
+static const ViewMode displayModes[9] = {
+	Left, Right, SBS_Full, SBS_Half, Free_View_Grid, Free_View_LRL, Horizontal, Vertical, Checkerboard };
+static const char* displayTags[9] = { "left", "right", "sbs", "sbs_half_width", "free_view", "free_view_lrl",
+	"horizontal", "vertical", "checkerboard" };
+
+void Render::parallelRows(int rows, const std::function<void(int, int)>& work) {
+	auto threadCount = renderThreads > 0 ? renderThreads : (int)std::thread::hardware_concurrency();
+	threadCount = std::clamp(threadCount, 1, std::max(rows / 16, 1));
+	if (threadCount == 1) {
+		work(0, rows);
+		return;
+	}
+	std::vector<std::thread> threads;
+	auto band = (rows + threadCount - 1) / threadCount;
+	for (auto start = band; start < rows; start += band)
+		threads.emplace_back(work, start, std::min(start + band, rows));
+	work(0, std::min(band, rows));
+	for (auto& thread : threads) thread.join();
+}
+
+glm::vec4 Render::sample(const SDL_Surface* surface, glm::vec2 uv) {
+	auto x = uv.x * (float)surface->w - 0.5f;
+	auto y = uv.y * (float)surface->h - 0.5f;
+	auto left = (int)std::floor(x), top = (int)std::floor(y);
+	auto fractionX = x - (float)left, fractionY = y - (float)top;
+	auto x0 = std::clamp(left, 0, surface->w - 1), x1 = std::clamp(left + 1, 0, surface->w - 1);
+	auto y0 = std::clamp(top, 0, surface->h - 1), y1 = std::clamp(top + 1, 0, surface->h - 1);
+	auto pixels = static_cast<const Uint8*>(surface->pixels);
+	auto texel = [&](int column, int row) {
+		auto source = pixels + (size_t)row * surface->pitch + (size_t)column * 4;
+		return glm::vec4(source[0], source[1], source[2], source[3]);
+	};
+	auto topColor = glm::mix(texel(x0, y0), texel(x1, y0), fractionX);
+	auto bottomColor = glm::mix(texel(x0, y1), texel(x1, y1), fractionX);
+	return glm::mix(topColor, bottomColor, fractionY) / 255.0f;
+}
+
+void Render::storeColor(Uint8* target, glm::vec4 color) {
+	for (auto c = 0; c < 3; ++c) target[c] = (Uint8)std::lround(std::clamp(color[c], 0.0f, 1.0f) * 255.0f);
+	target[3] = 255;
+}
+
+float Render::getDepth(const SDL_Surface* colorDepth, glm::vec2 uv) {
+	auto ndc = (1.0f - sample(colorDepth, uv).r) * 2.0f - 1.0f;
+	return (2.0f * zNear * zFar) / (zFar + zNear - ndc * (zFar - zNear)) / (zFar - zNear);
+}
+
+glm::vec2 Render::clampEdge(glm::vec2 uv, glm::vec2 minimum, glm::vec2 maximum) {
+	if (uv.x < minimum.x) uv.x = (minimum.x - uv.x) * edgeStretch;
+	if (uv.x > maximum.x) uv.x = maximum.x + (maximum.x - uv.x) * edgeStretch;
+	return glm::clamp(uv, minimum, maximum);
+}
+
+glm::vec2 Render::effectZoom(const SDL_Surface* colorDepth, glm::vec2 uv, glm::vec2 depthUV, float depthEffect) {
+	auto parallax = (depthEffect * 1.2f - 0.8f) * 0.1f;
+	auto depth = sample(colorDepth, depthUV).r;
+	auto direction = uv - 0.5f;
+	direction.x *= 0.5f;
+	auto samples = 3;
+	auto offset = direction * parallax / (float)samples;
+	auto result = depthUV;
+	while (samples-- > 0) {
+		depth = std::min(depth, sample(colorDepth, result).r);
+		result -= depth * offset;
+	}
+	return result * glm::vec2(2.0f, 1.0f) - glm::vec2(1.0f, 0.0f);
+}
+
+glm::vec2 Render::effectDolly(const SDL_Surface* colorDepth, glm::vec2 uv, glm::vec2 depthUV, float depthEffect) {
+	auto parallax = (depthEffect * 1.2f - 0.8f) * 0.1f;
+	auto depth = 1.0f - sample(colorDepth, depthUV).r;
+	auto direction = uv - 0.5f;
+	direction.x *= 0.5f;
+	auto samples = 3;
+	auto offset = direction * parallax / (float)samples;
+	auto result = depthUV;
+	while (samples-- > 0) {
+		depth = std::min(depth, 1.0f - sample(colorDepth, result).r);
+		result += depth * offset;
+	}
+	return result * glm::vec2(2.0f, 1.0f) - glm::vec2(1.0f, 0.0f);
+}
+
+int Render::renderZoom(const SDL_Surface* colorDepth, SDL_Surface* output, const SDL_Rect* rect,
+	float depthEffect, int effect) {
+	if (colorDepth == nullptr || output == nullptr || colorDepth->format != SDL_PIXELFORMAT_ABGR8888 ||
+		output->format != SDL_PIXELFORMAT_ABGR8888) return -1;
+	auto area = rect ? *rect : SDL_Rect{ 0, 0, output->w, output->h };
+	if (area.w <= 0 || area.h <= 0 || area.x < 0 || area.y < 0 || area.x + area.w > output->w ||
+		area.y + area.h > output->h) return -1;
+
+	for (auto y = 0; y < area.h; ++y) {
+		auto row = static_cast<Uint8*>(output->pixels) + (size_t)(area.y + y) * output->pitch + (size_t)area.x * 4;
+		for (auto x = 0; x < area.w; ++x) {
+			glm::vec2 fragUV((x + 0.5f) / (float)area.w, (y + 0.5f) / (float)area.h);
+			auto zoomFragUV = fragUV * 0.95f + 0.025f;
+			glm::vec2 zoomDepthUV(zoomFragUV.x * 0.5f + 0.5f, zoomFragUV.y);
+			auto zoomUV = effect == 0 ? effectZoom(colorDepth, zoomFragUV, zoomDepthUV, depthEffect) :
+				effectDolly(colorDepth, zoomFragUV, zoomDepthUV, depthEffect);
+			zoomUV.x *= 0.5f;
+			zoomUV = glm::clamp(zoomUV, glm::vec2(0.0f, 0.0f), glm::vec2(0.495f, 1.0f));
+			storeColor(row + (size_t)x * 4, sample(colorDepth, zoomUV));
+		}
+	}
+	return 0;
+}
+
+ViewMode Render::getMode(const std::string& tag) {
+	for (auto i = 0; i < 9; ++i) {
+		if (tag == displayTags[i]) return displayModes[i];
+	}
+	return Native;
+}
+
+std::string Render::getModeTag(ViewMode mode) {
+	for (auto i = 0; i < 9; ++i) {
+		if (mode == displayModes[i]) return displayTags[i];
+	}
+	return "";
+}
+
+SDL_Rect Render::getFitRect(const SDL_Surface* colorDepth, int width, int height) {
+	auto aspect = (double)(colorDepth->w / 2) / (double)colorDepth->h;
+	auto fitWidth = width, fitHeight = height;
+	if (aspect > (double)width / height) fitHeight = std::max((int)std::lround(width / aspect), 1);
+	else fitWidth = std::max((int)std::lround(height * aspect), 1);
+	return { (width - fitWidth) / 2, (height - fitHeight) / 2, fitWidth, fitHeight };
+}
+
+int Render::getCells(ViewMode mode, int width, int height, SDL_Rect* cells, bool* leftCells) {
+	auto columns = 1, rows = 1;
+	if (mode == SBS_Full || mode == SBS_Half) columns = 2;
+	else if (mode == Free_View_Grid) columns = rows = 2;
+	else if (mode == Free_View_LRL) columns = 3;
+	else if (mode != Left && mode != Right) return 0;
+
+	auto count = 0;
+	for (auto row = 0; row < rows; ++row) {
+		for (auto column = 0; column < columns; ++column, ++count) {
+			auto left = width * column / columns, top = height * row / rows;
+			cells[count] = { left, top, width * (column + 1) / columns - left, height * (row + 1) / rows - top };
+			leftCells[count] = mode == Right ? false : (column + row % 2) % 2 == 0;
+		}
+	}
+	return count;
+}
+
+glm::ivec2 Render::getViewSize(ViewMode mode, int width, int height) {
+	SDL_Rect cells[4];
+	bool leftCells[4];
+	if (getCells(mode, width, height, cells, leftCells) == 0) return { width, height };
+	return { cells[0].w, cells[0].h };
+}
+
+glm::ivec2 Render::getDisplaySize(ViewMode mode, const SDL_Surface* colorDepth) {
+	auto width = colorDepth->w / 2, height = colorDepth->h;
+	if (mode == SBS_Full) return { width * 2, height };
+	if (mode == Free_View_LRL) return { width * 3 / 2, height / 2 };
+	return { width, height };
+}
+
+int Render::renderViews(const SDL_Surface* colorDepth, const StereoParameters& parameters, SDL_Surface* left,
+	SDL_Surface* right, const SDL_Rect* rect) {
+	if (colorDepth == nullptr || left == nullptr || right == nullptr ||
+		colorDepth->format != SDL_PIXELFORMAT_ABGR8888 || left->format != SDL_PIXELFORMAT_ABGR8888 ||
+		right->format != SDL_PIXELFORMAT_ABGR8888 || left->w != right->w || left->h != right->h) return -1;
+	auto area = rect ? *rect : SDL_Rect{ 0, 0, left->w, left->h };
+	if (area.w <= 0 || area.h <= 0 || area.x < 0 || area.y < 0 || area.x + area.w > left->w ||
+		area.y + area.h > left->h) return -1;
+
+	const glm::vec2 minUVColor(uvGutter, 0.0f), maxUVColor(0.5f - uvGutter, 1.0f);
+	const glm::vec2 minUVDepth(0.5f + uvGutter, 0.0f), maxUVDepth(1.0f - uvGutter, 1.0f);
+	auto aspect = (float)colorDepth->w * 0.5f / (float)colorDepth->h;
+	auto scale = parameters.strength / aspect / stereoScale;
+	auto leftView = parameters.swapLeftRight ? right : left;
+	auto rightView = parameters.swapLeftRight ? left : right;
+
+	parallelRows(area.h, [&](int first, int last) {
+		for (auto y = first; y < last; ++y) {
+			auto leftRow = static_cast<Uint8*>(leftView->pixels) + (size_t)(area.y + y) * leftView->pitch +
+				(size_t)area.x * 4;
+			auto rightRow = static_cast<Uint8*>(rightView->pixels) + (size_t)(area.y + y) * rightView->pitch +
+				(size_t)area.x * 4;
+			for (auto x = 0; x < area.w; ++x) {
+				glm::vec2 screenUV((x + 0.5f) / (float)area.w, (y + 0.5f) / (float)area.h);
+				glm::vec2 colorUV(screenUV.x * 0.5f, screenUV.y);
+				glm::vec2 depthUV(screenUV.x * 0.5f + 0.5f, screenUV.y);
+
+				auto minDepthLeft = getDepth(colorDepth, clampEdge(depthUV, minUVDepth, maxUVDepth));
+				auto minDepthRight = minDepthLeft;
+				for (auto depthSample : depthSamples) {
+					glm::vec2 uv(depthSample * scale + parameters.offset, 0.0f);
+					minDepthLeft = std::min(minDepthLeft,
+						getDepth(colorDepth, clampEdge(depthUV + uv, minUVDepth, maxUVDepth)));
+					minDepthRight = std::min(minDepthRight,
+						getDepth(colorDepth, clampEdge(depthUV - uv, minUVDepth, maxUVDepth)));
+				}
+
+				auto parallaxLeft = scale * -parameters.depth / minDepthLeft + parameters.offset;
+				auto parallaxRight = scale * -parameters.depth / minDepthRight + parameters.offset;
+				storeColor(leftRow + (size_t)x * 4, sample(colorDepth,
+					clampEdge(colorUV + glm::vec2(parallaxLeft, 0.0f), minUVColor, maxUVColor)));
+				storeColor(rightRow + (size_t)x * 4, sample(colorDepth,
+					clampEdge(colorUV - glm::vec2(parallaxRight, 0.0f), minUVColor, maxUVColor)));
+			}
+		}
+	});
+	return 0;
+}
+
+void Render::copyCell(const SDL_Surface* view, SDL_Surface* output, const SDL_Rect& cell) {
+	parallelRows(cell.h, [&](int first, int last) {
+		for (auto y = first; y < last; ++y) {
+			auto target = static_cast<Uint8*>(output->pixels) + (size_t)(cell.y + y) * output->pitch +
+				(size_t)cell.x * 4;
+			if (std::abs(view->w - cell.w) <= 1 && std::abs(view->h - cell.h) <= 1) {
+				auto source = static_cast<const Uint8*>(view->pixels) + (size_t)std::min(y, view->h - 1) * view->pitch;
+				auto width = std::min(view->w, cell.w);
+				std::memcpy(target, source, (size_t)width * 4);
+				if (width < cell.w) std::memcpy(target + (size_t)width * 4, source + (size_t)(width - 1) * 4, 4);
+				continue;
+			}
+			for (auto x = 0; x < cell.w; ++x) {
+				storeColor(target + (size_t)x * 4, sample(view,
+					glm::vec2((x + 0.5f) / (float)cell.w, (y + 0.5f) / (float)cell.h)));
+			}
+		}
+	});
+}
+
+void Render::interleaveColumns(const Uint32* first, const Uint32* second, Uint32* output, int width) {
+	auto x = 0;
+#ifdef __AVX__
+	for (; x + 8 <= width; x += 8) {
+		auto even = _mm256_loadu_ps(reinterpret_cast<const float*>(first + x));
+		auto odd = _mm256_loadu_ps(reinterpret_cast<const float*>(second + x));
+		_mm256_storeu_ps(reinterpret_cast<float*>(output + x), _mm256_blend_ps(even, odd, 0xAA));
+	}
+#endif
+	for (; x + 1 < width; x += 2) {
+		output[x] = first[x];
+		output[x + 1] = second[x + 1];
+	}
+	if (x < width) output[x] = first[x];
+}
+
+int Render::composite(const SDL_Surface* left, const SDL_Surface* right, ViewMode mode, SDL_Surface* output) {
+	if (left == nullptr || right == nullptr || output == nullptr || left->format != SDL_PIXELFORMAT_ABGR8888 ||
+		right->format != SDL_PIXELFORMAT_ABGR8888 || output->format != SDL_PIXELFORMAT_ABGR8888) return -1;
+
+	SDL_Rect cells[4];
+	bool leftCells[4];
+	auto cellCount = getCells(mode, output->w, output->h, cells, leftCells);
+	if (cellCount > 0) {
+		for (auto i = 0; i < cellCount; ++i) copyCell(leftCells[i] ? left : right, output, cells[i]);
+		return 0;
+	}
+	if (mode != Horizontal && mode != Vertical && mode != Checkerboard) return -1;
+
+	SDL_Surface* scaled[2] = { nullptr, nullptr };
+	const SDL_Surface* views[2] = { left, right };
+	for (auto i = 0; i < 2; ++i) {
+		if (views[i]->w == output->w && views[i]->h == output->h) continue;
+		scaled[i] = SDL_CreateSurface(output->w, output->h, SDL_PIXELFORMAT_ABGR8888);
+		if (scaled[i] == nullptr) {
+			SDL_DestroySurface(scaled[0]);
+			return -1;
+		}
+		copyCell(views[i], scaled[i], { 0, 0, output->w, output->h });
+		views[i] = scaled[i];
+	}
+
+	parallelRows(output->h, [&](int first, int last) {
+		for (auto y = first; y < last; ++y) {
+			auto leftRow = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(views[0]->pixels) +
+				(size_t)y * views[0]->pitch);
+			auto rightRow = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(views[1]->pixels) +
+				(size_t)y * views[1]->pitch);
+			auto target = reinterpret_cast<Uint32*>(static_cast<Uint8*>(output->pixels) + (size_t)y * output->pitch);
+			auto leftFirst = y % 2 == 0;
+			if (mode == Horizontal) std::memcpy(target, leftFirst ? leftRow : rightRow, (size_t)output->w * 4);
+			else if (mode == Vertical || leftFirst) interleaveColumns(leftRow, rightRow, target, output->w);
+			else interleaveColumns(rightRow, leftRow, target, output->w);
+		}
+	});
+	SDL_DestroySurface(scaled[0]);
+	SDL_DestroySurface(scaled[1]);
+	return 0;
+}
+
+int Render::renderDisplay(const SDL_Surface* colorDepth, const StereoParameters& parameters, ViewMode mode,
+	SDL_Surface* output, SDL_Color background) {
+	if (colorDepth == nullptr || output == nullptr) return -1;
+	auto viewSize = getViewSize(mode, output->w, output->h);
+	auto squeeze = mode == SBS_Half ? 2 : 1;
+	auto rect = getFitRect(colorDepth, viewSize.x * squeeze, viewSize.y);
+	if (rect.w >= viewSize.x * squeeze - 1 && rect.h >= viewSize.y - 1) rect = { 0, 0, viewSize.x, viewSize.y };
+	else rect = { rect.x / squeeze, rect.y, std::max(rect.w / squeeze, 1), rect.h };
+	SDL_Surface* views[2] = { SDL_CreateSurface(viewSize.x, viewSize.y, SDL_PIXELFORMAT_ABGR8888),
+		SDL_CreateSurface(viewSize.x, viewSize.y, SDL_PIXELFORMAT_ABGR8888) };
+	auto result = views[0] && views[1] ? 0 : -1;
+	if (result == 0 && (rect.w < viewSize.x || rect.h < viewSize.y)) {
+		for (auto view : views)
+			SDL_FillSurfaceRect(view, nullptr, SDL_MapSurfaceRGB(view, background.r, background.g, background.b));
+	}
+	if (result == 0) result = renderViews(colorDepth, parameters, views[0], views[1], &rect);
+	if (result == 0) result = composite(views[0], views[1], mode, output);
+	SDL_DestroySurface(views[0]);
+	SDL_DestroySurface(views[1]);
+	return result;
+}
\ No newline at end of file
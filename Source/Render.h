@@ -0,0 +1,66 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RENDEPTH_RENDER_H
+#define RENDEPTH_RENDER_H
+
+#include <SDL3/SDL.h>
+#include "glm/glm.hpp"
+#include "Core.h"
+#include <functional>
+#include <string>
+
+struct StereoParameters {
+	float strength;
+	float depth;
+	float offset;
+	bool swapLeftRight;
+};
+
+class Render {
+public:
+	inline static int renderThreads = 0;
+
+	static int renderZoom(const SDL_Surface* colorDepth, SDL_Surface* output, const SDL_Rect* rect,
+		float depthEffect, int effect);
+	static ViewMode getMode(const std::string& tag);
+	static std::string getModeTag(ViewMode mode);
+	static SDL_Rect getFitRect(const SDL_Surface* colorDepth, int width, int height);
+	static glm::ivec2 getViewSize(ViewMode mode, int width, int height);
+	static glm::ivec2 getDisplaySize(ViewMode mode, const SDL_Surface* colorDepth);
+	static int renderViews(const SDL_Surface* colorDepth, const StereoParameters& parameters, SDL_Surface* left,
+		SDL_Surface* right, const SDL_Rect* rect = nullptr);
+	static int composite(const SDL_Surface* left, const SDL_Surface* right, ViewMode mode, SDL_Surface* output);
+	static int renderDisplay(const SDL_Surface* colorDepth, const StereoParameters& parameters, ViewMode mode,
+		SDL_Surface* output, SDL_Color background);
+private:
+	static void parallelRows(int rows, const std::function<void(int, int)>& work);
+	static int getCells(ViewMode mode, int width, int height, SDL_Rect* cells, bool* leftCells);
+	static float getDepth(const SDL_Surface* colorDepth, glm::vec2 uv);
+	static glm::vec2 clampEdge(glm::vec2 uv, glm::vec2 minimum, glm::vec2 maximum);
+	static void storeColor(Uint8* target, glm::vec4 color);
+	static void copyCell(const SDL_Surface* view, SDL_Surface* output, const SDL_Rect& cell);
+	static void interleaveColumns(const Uint32* first, const Uint32* second, Uint32* output, int width);
+	static glm::vec4 sample(const SDL_Surface* surface, glm::vec2 uv);
+	static glm::vec2 effectZoom(const SDL_Surface* colorDepth, glm::vec2 uv, glm::vec2 depthUV, float depthEffect);
+	static glm::vec2 effectDolly(const SDL_Surface* colorDepth, glm::vec2 uv, glm::vec2 depthUV, float depthEffect);
+};
+
+#endif
\ No newline at end of file
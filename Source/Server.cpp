@@ -0,0 +1,317 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Server.h"
+#include "rapidjson/document.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/stringbuffer.h"
+#include <zmq_addon.hpp>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <thread>
+
+static const char* timingNames[5] = { "queue", "load", "render", "encode", "total" };
+
+static double getMilliseconds(Uint64 start, Uint64 end) {
+	return (double)(end - start) / 1e6;
+}
+
+bool Server::parseJob(std::vector<zmq::message_t>& frames, ServerJob& job, std::string& command,
+	std::string& error) {
+	job.peer = frames[0].to_string();
+	job.delimiter = frames.size() > 2 && frames[1].size() == 0;
+	auto first = job.delimiter ? 2 : 1;
+	job.received = SDL_GetTicksNS();
+	job.preset = defaultPreset;
+
+	rapidjson::Document document;
+	auto text = frames[first].to_string();
+	if (document.Parse(text.c_str()).HasParseError() || !document.IsObject()) {
+		error = "Invalid JSON";
+		return false;
+	}
+	auto getString = [&](const char* name, std::string& value) {
+		if (document.HasMember(name) && document[name].IsString()) value = document[name].GetString();
+	};
+	getString("command", command);
+	if (document.HasMember("id")) {
+		if (document["id"].IsString()) job.id = document["id"].GetString();
+		else if (document["id"].IsInt64()) job.id = std::to_string(document["id"].GetInt64());
+	}
+	if (!command.empty()) return true;
+
+	std::string presetName;
+	getString("preset", presetName);
+	if (!presetName.empty()) {
+		auto found = std::find_if(presets.begin(), presets.end(),
+			[&](const ExportPreset& preset) { return preset.name == presetName; });
+		if (found == presets.end()) {
+			error = "Unknown Preset: " + presetName;
+			return false;
+		}
+		job.preset = *found;
+	}
+	getString("path", job.path);
+	getString("name", job.name);
+	if ((int)frames.size() > first + 1) job.data = frames[first + 1].to_string();
+	if (!Preset::parse(document, job.preset, error)) return false;
+	if (!Preset::canRender(job.preset)) error = Render::getMode(job.preset.format) != Native ?
+		"Blur Background Needs --export" : "Unknown Format: " + job.preset.format;
+	else if (job.path.empty() && job.data.empty()) error = "No Source";
+	return error.empty();
+}
+
+std::string Server::getHeader(const ServerJob& job, const char* status, const std::string& error,
+	int width, int height, const double* timings, const std::string& source) {
+	rapidjson::StringBuffer output;
+	rapidjson::Writer writer(output);
+	writer.StartObject();
+	writer.Key("id");
+	writer.String(job.id.c_str());
+	writer.Key("status");
+	writer.String(status);
+	if (!error.empty()) {
+		writer.Key("error");
+		writer.String(error.c_str());
+	}
+	if (width > 0 && height > 0) {
+		writer.Key("width");
+		writer.Int(width);
+		writer.Key("height");
+		writer.Int(height);
+		writer.Key("encoding");
+		writer.String(job.preset.encoding == Encoding_Png ? "png" : "jpeg");
+	}
+	if (!source.empty()) {
+		writer.Key("source");
+		writer.String(source.c_str());
+	}
+	if (timings != nullptr) {
+		writer.Key("timings");
+		writer.StartObject();
+		for (auto i = 0; i < 5; ++i) {
+			writer.Key(timingNames[i]);
+			writer.Double(timings[i]);
+		}
+		writer.EndObject();
+	}
+	writer.EndObject();
+	return output.GetString();
+}
+
+std::string Server::getStatus(const ServerJob& job, int workers) {
+	auto queued = 0;
+	{
+		std::lock_guard lock(jobMutex);
+		queued = (int)jobs.size();
+	}
+	rapidjson::StringBuffer output;
+	rapidjson::Writer writer(output);
+	writer.StartObject();
+	writer.Key("id");
+	writer.String(job.id.c_str());
+	writer.Key("status");
+	writer.String("ready");
+	writer.Key("workers");
+	writer.Int(workers);
+	writer.Key("queued");
+	writer.Int(queued);
+	writer.Key("pending");
+	writer.Int(pendingJobs);
+	writer.Key("completed");
+	writer.Int(completedJobs);
+	writer.EndObject();
+	return output.GetString();
+}
+
+ServerReply Server::processJob(const ServerJob& job) {
+	ServerReply reply{ job.peer, job.delimiter };
+	reply.queued = true;
+	double timings[5] = {};
+	auto started = SDL_GetTicksNS();
+	timings[0] = getMilliseconds(job.received, started);
+
+	auto color = job.data.empty() ? nullptr : Core::loadImageMemory(job.data.data(), job.data.size());
+	std::string source;
+	auto colorDepth = job.data.empty() ? loader(job.path, nullptr, source) :
+		color ? loader(job.name, color, source) : nullptr;
+	auto loaded = SDL_GetTicksNS();
+	timings[1] = getMilliseconds(started, loaded);
+	if (colorDepth == nullptr) {
+		reply.header = getHeader(job, "error", "Could Not Load Source");
+		return reply;
+	}
+
+	auto output = Preset::render(colorDepth, job.preset);
+	SDL_DestroySurface(colorDepth);
+	if (output == nullptr) {
+		reply.header = getHeader(job, "error", "Render Failed");
+		return reply;
+	}
+	auto rendered = SDL_GetTicksNS();
+	timings[2] = getMilliseconds(loaded, rendered);
+
+	auto result = Preset::encode(output, job.preset, reply.image);
+	auto encoded = SDL_GetTicksNS();
+	timings[3] = getMilliseconds(rendered, encoded);
+	timings[4] = getMilliseconds(job.received, encoded);
+	if (result != 0) reply.image.clear();
+	reply.header = result != 0 ? getHeader(job, "error", "Encode Failed") :
+		getHeader(job, "done", "", output->w, output->h, timings, source);
+	SDL_DestroySurface(output);
+	return reply;
+}
+
+void Server::workerRun(zmq::context_t& context) {
+	zmq::socket_t wake(context, zmq::socket_type::push);
+	wake.set(zmq::sockopt::linger, 0);
+	wake.connect(wakeEndpoint);
+	while (true) {
+		ServerJob job;
+		{
+			std::unique_lock lock(jobMutex);
+			jobReady.wait(lock, []() { return stopping || !jobs.empty(); });
+			if (jobs.empty()) return;
+			job = std::move(jobs.front());
+			jobs.pop_front();
+		}
+		auto reply = processJob(job);
+		{
+			std::lock_guard lock(replyMutex);
+			replies.push_back(std::move(reply));
+		}
+		wake.send(zmq::const_buffer(), zmq::send_flags::dontwait);
+	}
+}
+
+bool Server::sendReply(zmq::socket_t& router, const ServerReply& reply) {
+	std::vector<zmq::const_buffer> buffers = { zmq::buffer(reply.peer) };
+	if (reply.delimiter) buffers.push_back(zmq::const_buffer());
+	buffers.push_back(zmq::buffer(reply.header));
+	if (!reply.image.empty()) buffers.push_back(zmq::buffer(reply.image.data(), reply.image.size()));
+	try {
+		return zmq::send_multipart(router, buffers, zmq::send_flags::dontwait).has_value();
+	} catch (const zmq::error_t& error) {
+		if (error.num() != EHOSTUNREACH) throw;
+		SDL_Log("Render Server Dropped Reply for Disconnected Client.");
+		return true;
+	}
+}
+
+int Server::run(const std::string& endpoint,
+	const std::function<SDL_Surface*(const std::filesystem::path&, SDL_Surface*, std::string&)>& loadColorDepth) {
+	auto hardwareThreads = std::max((int)std::thread::hardware_concurrency(), 1);
+	auto workers = workerCount > 0 ? workerCount : std::max(hardwareThreads / 2, 1);
+	auto queueLimit = maxQueued > 0 ? maxQueued : workers * 2;
+	Preset::shareThreads(workers);
+	loader = loadColorDepth;
+
+	zmq::context_t context{1};
+	zmq::socket_t router(context, zmq::socket_type::router);
+	router.set(zmq::sockopt::linger, lingerTime);
+	router.set(zmq::sockopt::rcvhwm, queueLimit);
+	router.set(zmq::sockopt::router_mandatory, true);
+	zmq::socket_t wake(context, zmq::socket_type::pull);
+	wake.bind(wakeEndpoint);
+	try {
+		router.bind(endpoint);
+	} catch (const zmq::error_t& error) {
+		SDL_Log("Render Server Could Not Bind %s: %s", endpoint.c_str(), error.what());
+		return -1;
+	}
+	SDL_Log("Render Server Listening on %s with %d Workers.", endpoint.c_str(), workers);
+
+	stopping = false;
+	std::vector<std::thread> threads;
+	for (auto i = 0; i < workers; ++i) threads.emplace_back(workerRun, std::ref(context));
+
+	std::deque<ServerReply> blocked;
+	auto send = [&](ServerReply&& reply) {
+		if (!sendReply(router, reply)) {
+			blocked.push_back(std::move(reply));
+			return;
+		}
+		if (!reply.queued) return;
+		--pendingJobs;
+		++completedJobs;
+	};
+	auto running = true;
+	while (running) {
+		zmq::pollitem_t items[] = {
+			{ router.handle(), 0, (short)(pendingJobs < queueLimit ? ZMQ_POLLIN : 0), 0 },
+			{ wake.handle(), 0, ZMQ_POLLIN, 0 } };
+		zmq::poll(items, 2, std::chrono::milliseconds(blocked.empty() ? -1 : pollTimeout));
+		while (running && pendingJobs < queueLimit && (items[0].revents & ZMQ_POLLIN)) {
+			std::vector<zmq::message_t> frames;
+			if (!zmq::recv_multipart(router, std::back_inserter(frames), zmq::recv_flags::dontwait)) break;
+			if (frames.size() < 2) continue;
+			ServerJob job{};
+			std::string command, error;
+			if (!parseJob(frames, job, command, error)) {
+				send({ job.peer, job.delimiter, getHeader(job, "error", error) });
+				continue;
+			}
+			if (command == "quit") {
+				send({ job.peer, job.delimiter, getHeader(job, "bye", "") });
+				running = false;
+			} else if (command == "status") {
+				send({ job.peer, job.delimiter, getStatus(job, workers) });
+			} else if (!command.empty()) {
+				send({ job.peer, job.delimiter, getHeader(job, "error", "Unknown Command: " + command) });
+			} else {
+				{
+					std::lock_guard lock(jobMutex);
+					jobs.push_back(std::move(job));
+				}
+				jobReady.notify_one();
+				++pendingJobs;
+			}
+		}
+
+		zmq::message_t signal;
+		while (wake.recv(signal, zmq::recv_flags::dontwait)) {}
+		std::deque<ServerReply> ready;
+		ready.swap(blocked);
+		{
+			std::lock_guard lock(replyMutex);
+			std::move(replies.begin(), replies.end(), std::back_inserter(ready));
+			replies.clear();
+		}
+		for (auto& reply : ready) send(std::move(reply));
+	}
+
+	{
+		std::lock_guard lock(jobMutex);
+		stopping = true;
+	}
+	jobReady.notify_all();
+	for (auto& thread : threads) thread.join();
+	for (auto& reply : replies) blocked.push_back(std::move(reply));
+	replies.clear();
+	for (const auto& reply : blocked) {
+		if (!sendReply(router, reply)) SDL_Log("Render Server Dropped Reply for Busy Client.");
+	}
+	SDL_Log("Render Server Stopped After %d Jobs.", completedJobs + pendingJobs);
+	wake.close();
+	router.close();
+	context.close();
+	return 0;
+}
\ No newline at end of file
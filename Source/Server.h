@@ -0,0 +1,85 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RENDEPTH_SERVER_H
+#define RENDEPTH_SERVER_H
+
+#include "Preset.h"
+#include <SDL3/SDL.h>
+#include <zmq.hpp>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct ServerJob {
+	std::string peer;
+	bool delimiter;
+	std::string id;
+	std::string path;
+	std::string name;
+	std::string data;
+	ExportPreset preset;
+	Uint64 received;
+};
+
+struct ServerReply {
+	std::string peer;
+	bool delimiter;
+	std::string header;
+	std::vector<Uint8> image;
+	bool queued = false;
+};
+
+class Server {
+public:
+	static int run(const std::string& endpoint,
+		const std::function<SDL_Surface*(const std::filesystem::path&, SDL_Surface*, std::string&)>& loadColorDepth);
+	inline static int workerCount = 0;
+	inline static int maxQueued = 0;
+	inline static int pollTimeout = 5;
+	inline static int lingerTime = 500;
+	inline static ExportPreset defaultPreset;
+	inline static std::vector<ExportPreset> presets;
+private:
+	static bool parseJob(std::vector<zmq::message_t>& frames, ServerJob& job, std::string& command,
+		std::string& error);
+	static void workerRun(zmq::context_t& context);
+	static ServerReply processJob(const ServerJob& job);
+	static std::string getHeader(const ServerJob& job, const char* status, const std::string& error,
+		int width = 0, int height = 0, const double* timings = nullptr, const std::string& source = "");
+	static std::string getStatus(const ServerJob& job, int workers);
+	static bool sendReply(zmq::socket_t& router, const ServerReply& reply);
+	inline static std::function<SDL_Surface*(const std::filesystem::path&, SDL_Surface*, std::string&)> loader;
+	inline static std::mutex jobMutex;
+	inline static std::condition_variable jobReady;
+	inline static std::deque<ServerJob> jobs;
+	inline static std::mutex replyMutex;
+	inline static std::deque<ServerReply> replies;
+	inline static int pendingJobs = 0;
+	inline static int completedJobs = 0;
+	inline static const char* wakeEndpoint = "inproc://render-server-wake";
+	inline static bool stopping = false;
+};
+
+#endif
\ No newline at end of file
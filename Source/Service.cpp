@@ -0,0 +1,720 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "Service.h"
+#include "rapidjson/document.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+#include <zmq_addon.hpp>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+int Service::start() {
+	if (pipeAlive) return 0;
+	if (pipeThread) {
+		SDL_WaitThread(pipeThread, nullptr);
+		pipeThread = nullptr;
+	}
+	auto launch = 1;
+	daemonMode = useDaemon && !daemonFile.empty();
+	connected = false;
+	launched = false;
+	static int clientCount = 0;
+#ifdef _WIN32
+	auto processId = (int)GetCurrentProcessId();
+#else
+	auto processId = (int)getpid();
+#endif
+	clientId = "rdp_" + std::to_string(processId) + "_" + std::to_string(clientCount++) + ":";
+	try {
+		socket = zmq::socket_t(context, zmq::socket_type::dealer);
+		socket.set(zmq::sockopt::linger, lingerTime);
+		socket.set(zmq::sockopt::routing_id, clientId);
+		if (daemonMode) {
+			std::string daemonEndpoint;
+			if (readDaemon(daemonEndpoint)) {
+				socket.connect(daemonEndpoint);
+				endpoint = daemonEndpoint;
+				connected = true;
+				launch = 0;
+			}
+		} else {
+			socket.bind("tcp://127.0.0.1:*");
+			endpoint = socket.get(zmq::sockopt::last_endpoint);
+			connected = true;
+		}
+	} catch (const zmq::error_t& error) {
+		SDL_Log("Could Not Bind Depth Service: %s", error.what());
+		return -1;
+	}
+	sendQuit = !daemonMode;
+	state = Service_Starting;
+	pipeAlive = true;
+	pipeThread = SDL_CreateThread(pipeRun, "depthPipeRun", nullptr);
+	if (!pipeThread) {
+		state = Service_Stopped;
+		pipeAlive = false;
+		socket.close();
+		return -1;
+	}
+	return launch;
+}
+
+int Service::launch(const std::string& program, const std::vector<std::string>& arguments) {
+	std::lock_guard lock(processMutex);
+	auto result = daemonMode ?
+		Process::spawn(process, program, arguments, Output_File, getDaemonPath(daemonLog).string(), true) :
+		Process::spawn(process, program, arguments, Output_Pipe);
+	if (result != 0) SDL_Log("Could Not Launch Depth Service.");
+	launched = result == 0;
+	return result;
+}
+
+bool Service::isReady() {
+	return state == Service_Ready;
+}
+
+std::string Service::getReadyInfo() {
+	std::lock_guard lock(infoMutex);
+	return readyInfo;
+}
+
+void Service::stop(bool shutdown) {
+	if (!pipeThread) return;
+	if (shutdown && (!daemonMode || launched)) sendQuit = true;
+	pipeAlive = false;
+	SDL_WaitThread(pipeThread, nullptr);
+	pipeThread = nullptr;
+	clear();
+	if (!metricsFile.empty()) writeMetrics(metricsFile);
+	std::lock_guard lock(jobMutex);
+	results.clear();
+}
+
+void Service::close() {
+	if (context.handle()) {
+		context.shutdown();
+		context.close();
+	}
+}
+
+int Service::submit(const std::string& path, int imageId, int priority, const SDL_Surface* color) {
+	DepthJob job = { 0, imageId, priority, path, SDL_GetTicks(), 0, {}, 0, 0 };
+	if (color && useSharedMemory && color->format == SDL_PIXELFORMAT_ABGR8888) {
+		auto rowSize = (size_t)color->w * 4;
+		if (createSharedBuffer(job.buffer, (size_t)color->w * color->h * 5) == 0) {
+			for (auto y = 0; y < color->h; ++y) {
+				std::memcpy(job.buffer.data + y * rowSize,
+					static_cast<const Uint8*>(color->pixels) + (size_t)y * color->pitch, rowSize);
+			}
+			job.width = color->w;
+			job.height = color->h;
+		} else {
+			SDL_Log("Could Not Create Shared Buffer, Sending Path Only.");
+		}
+	}
+	std::lock_guard lock(jobMutex);
+	job.id = nextJobId++;
+	queuedJobs.push_back(job);
+	return job.id;
+}
+
+bool Service::poll(DepthResult& result) {
+	std::lock_guard lock(jobMutex);
+	if (results.empty()) return false;
+	result = std::move(results.front());
+	results.pop_front();
+	return true;
+}
+
+void Service::clear() {
+	std::lock_guard lock(jobMutex);
+	for (auto& job : queuedJobs) releaseSharedBuffer(job.buffer);
+	for (auto& job : sentJobs) releaseSharedBuffer(job.buffer);
+	queuedJobs.clear();
+	sentJobs.clear();
+	cancelledJobs.clear();
+}
+
+bool Service::promote(int imageId) {
+	std::lock_guard lock(jobMutex);
+	auto found = false;
+	for (auto& job : queuedJobs) {
+		if (job.imageId != imageId) continue;
+		job.priority = Priority_Current;
+		found = true;
+	}
+	for (auto& job : sentJobs) {
+		if (job.imageId != imageId) continue;
+		job.priority = Priority_Current;
+		found = true;
+	}
+	return found;
+}
+
+void Service::cancelSpeculative(const std::vector<int>& keepIds) {
+	std::lock_guard lock(jobMutex);
+	std::erase_if(queuedJobs, [&keepIds](DepthJob& job) {
+		if (job.priority != Priority_Speculative ||
+			std::find(keepIds.begin(), keepIds.end(), job.imageId) != keepIds.end()) return false;
+		releaseSharedBuffer(job.buffer);
+		return true;
+	});
+}
+
+void Service::cancelRefinement(const std::vector<int>& keepIds) {
+	std::lock_guard lock(jobMutex);
+	std::erase_if(sentJobs, [&keepIds](DepthJob& job) {
+		if (!job.refining || std::find(keepIds.begin(), keepIds.end(), job.imageId) != keepIds.end()) return false;
+		releaseSharedBuffer(job.buffer);
+		cancelledJobs.push_back(job.id);
+		return true;
+	});
+}
+
+bool Service::isPending(int imageId) {
+	std::lock_guard lock(jobMutex);
+	auto matches = [imageId](const DepthJob& job) { return job.imageId == imageId; };
+	return std::any_of(queuedJobs.begin(), queuedJobs.end(), matches) ||
+		std::any_of(sentJobs.begin(), sentJobs.end(), matches);
+}
+
+int Service::getPendingCount() {
+	std::lock_guard lock(jobMutex);
+	return (int)(queuedJobs.size() + sentJobs.size());
+}
+
+bool Service::isRunning() {
+	return pipeAlive;
+}
+
+bool Service::isProcessAlive(int processId) {
+	if (processId <= 0) return false;
+#ifdef _WIN32
+	auto process = OpenProcess(SYNCHRONIZE, FALSE, (DWORD)processId);
+	if (!process) return false;
+	auto alive = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+	CloseHandle(process);
+	return alive;
+#else
+	Process::reap();
+	return kill(processId, 0) == 0 || errno == EPERM;
+#endif
+}
+
+std::filesystem::path Service::getDaemonPath(const std::filesystem::path& path) {
+	auto key = daemonSettings;
+	std::replace(key.begin(), key.end(), ' ', '_');
+	return path.parent_path() / (path.stem().string() + "_" + key + path.extension().string());
+}
+
+bool Service::readDaemon(std::string& daemonEndpoint) {
+	auto daemonPath = getDaemonPath(daemonFile);
+	std::ifstream file(daemonPath);
+	if (!file) return false;
+	std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	file.close();
+
+	rapidjson::Document document;
+	if (document.Parse(text.c_str()).HasParseError() || !document.IsObject()) return false;
+	if (!document.HasMember("endpoint") || !document["endpoint"].IsString() ||
+		!document.HasMember("pid") || !document["pid"].IsInt() ||
+		!document.HasMember("settings") || !document["settings"].IsString()) return false;
+
+	std::error_code error;
+	if (!isProcessAlive(document["pid"].GetInt())) {
+		std::filesystem::remove(daemonPath, error);
+		return false;
+	}
+	if (daemonSettings != document["settings"].GetString()) return false;
+	daemonEndpoint = document["endpoint"].GetString();
+	return true;
+}
+
+void Service::removeDaemon(const std::string& daemonEndpoint) {
+	auto daemonPath = getDaemonPath(daemonFile);
+	std::ifstream file(daemonPath);
+	if (!file) return;
+	std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	file.close();
+
+	rapidjson::Document document;
+	if (document.Parse(text.c_str()).HasParseError() || !document.IsObject() ||
+		!document.HasMember("endpoint") || !document["endpoint"].IsString() ||
+		daemonEndpoint != document["endpoint"].GetString()) return;
+	std::error_code error;
+	std::filesystem::remove(daemonPath, error);
+}
+
+void Service::failPending(const std::string& message) {
+	std::lock_guard lock(jobMutex);
+	auto fail = [&message](DepthJob& job) {
+		releaseSharedBuffer(job.buffer);
+		results.push_back({ job.id, job.imageId, job.priority, message, true,
+			SDL_GetTicks() - job.submitted, {}, 0, 0, false, job.refining,
+			(job.sent ? job.sent : SDL_GetTicks()) - job.submitted });
+	};
+	std::for_each(sentJobs.begin(), sentJobs.end(), fail);
+	std::for_each(queuedJobs.begin(), queuedJobs.end(), fail);
+	sentJobs.clear();
+	queuedJobs.clear();
+}
+
+int Service::createSharedBuffer(SharedBuffer& buffer, size_t size) {
+	static int bufferCount = 0;
+#ifdef _WIN32
+	auto processId = (int)GetCurrentProcessId();
+#else
+	auto processId = (int)getpid();
+#endif
+	buffer = { "rdp_" + std::to_string(processId) + "_" + std::to_string(bufferCount++), nullptr, size, nullptr };
+#ifdef _WIN32
+	auto mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+		(DWORD)((Uint64)size >> 32), (DWORD)(size & 0xFFFFFFFF), buffer.name.c_str());
+	if (!mapping) return -1;
+	buffer.data = static_cast<Uint8*>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+	if (!buffer.data) {
+		CloseHandle(mapping);
+		return -1;
+	}
+	buffer.handle = mapping;
+#else
+	auto sharedName = "/" + buffer.name;
+	auto descriptor = shm_open(sharedName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+	if (descriptor < 0) return -1;
+	void* mapped = MAP_FAILED;
+	if (ftruncate(descriptor, (off_t)size) == 0)
+		mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+	::close(descriptor);
+	if (mapped == MAP_FAILED) {
+		shm_unlink(sharedName.c_str());
+		return -1;
+	}
+	buffer.data = static_cast<Uint8*>(mapped);
+#endif
+	return 0;
+}
+
+void Service::releaseSharedBuffer(SharedBuffer& buffer) {
+	if (!buffer.data) return;
+#ifdef _WIN32
+	UnmapViewOfFile(buffer.data);
+	CloseHandle(buffer.handle);
+#else
+	munmap(buffer.data, buffer.size);
+	shm_unlink(("/" + buffer.name).c_str());
+#endif
+	buffer.data = nullptr;
+}
+
+int Service::openSharedBuffer(SharedBuffer& buffer, const std::string& name, size_t size) {
+	buffer = { name, nullptr, size, nullptr };
+#ifdef _WIN32
+	auto mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+	if (!mapping) return -1;
+	buffer.data = static_cast<Uint8*>(MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+	if (!buffer.data) {
+		CloseHandle(mapping);
+		return -1;
+	}
+	buffer.handle = mapping;
+#else
+	auto descriptor = shm_open(("/" + name).c_str(), O_RDWR, 0600);
+	if (descriptor < 0) return -1;
+	struct stat info{};
+	void* mapped = MAP_FAILED;
+	if (fstat(descriptor, &info) == 0 && (size_t)info.st_size >= size)
+		mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+	::close(descriptor);
+	if (mapped == MAP_FAILED) return -1;
+	buffer.data = static_cast<Uint8*>(mapped);
+#endif
+	return 0;
+}
+
+void Service::closeSharedBuffer(SharedBuffer& buffer) {
+	if (!buffer.data) return;
+#ifdef _WIN32
+	UnmapViewOfFile(buffer.data);
+	CloseHandle(buffer.handle);
+#else
+	munmap(buffer.data, buffer.size);
+#endif
+	buffer.data = nullptr;
+}
+
+bool Service::sendJob(const DepthJob& job) {
+	auto jobId = std::to_string(job.id);
+	auto priority = std::to_string(job.priority);
+	std::string shared;
+	if (job.buffer.data)
+		shared = job.buffer.name + " " + std::to_string(job.width) + " " + std::to_string(job.height);
+	std::array<zmq::const_buffer, 5> frames = { zmq::str_buffer("job"), zmq::buffer(jobId),
+		zmq::buffer(priority), zmq::buffer(job.path), zmq::buffer(shared) };
+	auto sent = zmq::send_multipart(socket, frames, zmq::send_flags::dontwait);
+	return sent.has_value();
+}
+
+bool Service::receiveResult() {
+	std::vector<zmq::message_t> frames;
+	auto received = zmq::recv_multipart(socket, std::back_inserter(frames), zmq::recv_flags::dontwait);
+	if (!received) return false;
+	lastMessage = SDL_GetTicks();
+	if (frames.empty()) return true;
+
+	auto type = frames[0].to_string();
+	if (type == "bye") {
+		quitAcknowledged = true;
+		return true;
+	}
+	if (type == "ready") {
+		if (state != Service_Ready && frames.size() >= 3) {
+			std::lock_guard lock(infoMutex);
+			readyInfo = frames[1].to_string() + " Model, " + frames[2].to_string();
+			SDL_Log("Depth Service Ready: %s.", readyInfo.c_str());
+		}
+		if (frames.size() >= 5 && frames[4].size() > 0) connectTelemetry(frames[4].to_string());
+		state = Service_Ready;
+		return true;
+	}
+	if (frames.size() < 3) return true;
+
+	auto id = std::atoi(frames[1].to_string().c_str());
+	std::lock_guard lock(jobMutex);
+	auto job = std::find_if(sentJobs.begin(), sentJobs.end(),
+		[id](const DepthJob& sent) { return sent.id == id; });
+	if (job == sentJobs.end()) return true;
+	DepthResult result = { id, job->imageId, job->priority, frames[2].to_string(),
+		type != "done" && type != "depth", SDL_GetTicks() - job->submitted, {}, 0, 0,
+		frames.size() >= 4 && frames[3].to_string() == "refine", job->refining, job->sent - job->submitted };
+	if (type == "depth") {
+		auto depthWidth = 0, depthHeight = 0;
+		std::sscanf(result.path.c_str(), "%dx%d", &depthWidth, &depthHeight);
+		if (job->buffer.data && depthWidth > 0 && depthHeight > 0 &&
+			(size_t)depthWidth * depthHeight <= (size_t)job->width * job->height) {
+			auto depthData = job->buffer.data + (size_t)job->width * job->height * 4;
+			result.depth.assign(depthData, depthData + (size_t)depthWidth * depthHeight);
+			result.depthWidth = depthWidth;
+			result.depthHeight = depthHeight;
+			result.path = job->path;
+		} else {
+			result.error = true;
+		}
+	}
+	if (!result.error && !result.draft) {
+		recordMetric("latency", (double)result.latency);
+		recordMetric("dispatch", (double)result.queued);
+	}
+	if (result.draft && !result.error) {
+		job->refining = true;
+		results.push_back(std::move(result));
+		return true;
+	}
+	releaseSharedBuffer(job->buffer);
+	results.push_back(std::move(result));
+	sentJobs.erase(job);
+	return true;
+}
+
+void Service::connectTelemetry(const std::string& telemetryEndpoint) {
+	if (telemetry.handle()) return;
+	try {
+		telemetry = zmq::socket_t(context, zmq::socket_type::sub);
+		telemetry.set(zmq::sockopt::linger, 0);
+		telemetry.set(zmq::sockopt::subscribe, clientId);
+		telemetry.connect(telemetryEndpoint);
+	} catch (const zmq::error_t& error) {
+		SDL_Log("Could Not Connect Depth Telemetry: %s", error.what());
+		telemetry.close();
+	}
+}
+
+bool Service::receiveTelemetry() {
+	std::vector<zmq::message_t> frames;
+	auto received = zmq::recv_multipart(telemetry, std::back_inserter(frames), zmq::recv_flags::dontwait);
+	if (!received) return false;
+	if (frames.size() < 2) return true;
+
+	rapidjson::Document document;
+	auto text = frames[1].to_string();
+	if (document.Parse(text.c_str()).HasParseError() || !document.IsObject() ||
+		!document.HasMember("stage") || !document["stage"].IsString()) return true;
+	std::string stage = document["stage"].GetString();
+	auto queue = document.HasMember("queue") && document["queue"].IsInt() ? document["queue"].GetInt() : 0;
+	{
+		std::lock_guard lock(metricsMutex);
+		peakQueue = std::max(peakQueue, queue);
+		if (document.HasMember("device") && document["device"].IsString())
+			metricsDevice = document["device"].GetString();
+	}
+	if (stage != "done" || !document.HasMember("timings") || !document["timings"].IsObject()) return true;
+
+	auto refine = document.HasMember("refine") && document["refine"].IsBool() && document["refine"].GetBool();
+	std::string summary;
+	auto total = 0.0;
+	auto& timings = document["timings"];
+	for (auto timing = timings.MemberBegin(); timing != timings.MemberEnd(); ++timing) {
+		if (!timing->value.IsNumber()) continue;
+		std::string name = timing->name.GetString();
+		auto value = timing->value.GetDouble();
+		recordMetric(refine ? "refine_" + name : name, value);
+		total += value;
+		if (!name.empty()) name[0] = (char)std::toupper((unsigned char)name[0]);
+		summary += name + " " + std::to_string((int)(value + 0.5)) + "ms, ";
+	}
+	recordMetric(refine ? "refine_service" : "service", total);
+	if (logTelemetry) {
+		auto id = document.HasMember("id") && document["id"].IsInt() ? document["id"].GetInt() : -1;
+		SDL_Log("Depth Job %d%s: %sQueue %d, %s.", id, refine ? " Refined" : "", summary.c_str(), queue,
+			document.HasMember("device") && document["device"].IsString() ? document["device"].GetString() : "");
+	}
+	return true;
+}
+
+void Service::recordMetric(const std::string& name, double value) {
+	std::lock_guard lock(metricsMutex);
+	auto& metric = metrics[name];
+	++metric.count;
+	metric.total += value;
+	metric.peak = std::max(metric.peak, value);
+}
+
+int Service::writeMetrics(const std::filesystem::path& path) {
+	rapidjson::StringBuffer output;
+	{
+		std::lock_guard lock(metricsMutex);
+		if (metrics.empty()) return 1;
+		rapidjson::PrettyWriter writer(output);
+		writer.StartObject();
+		writer.Key("device");
+		writer.String(metricsDevice.c_str());
+		writer.Key("peakQueue");
+		writer.Int(peakQueue);
+		writer.Key("stages");
+		writer.StartObject();
+		for (const auto& [name, metric] : metrics) {
+			writer.Key(name.c_str());
+			writer.StartObject();
+			writer.Key("count");
+			writer.Int(metric.count);
+			writer.Key("mean");
+			writer.Double(metric.total / std::max(metric.count, 1));
+			writer.Key("max");
+			writer.Double(metric.peak);
+			writer.Key("total");
+			writer.Double(metric.total);
+			writer.EndObject();
+		}
+		writer.EndObject();
+		writer.EndObject();
+	}
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file) return -1;
+	file.write(output.GetString(), (std::streamsize)output.GetSize());
+	return file ? 0 : -1;
+}
+
+bool Service::sendControl(const char* message) {
+	try {
+		return socket.send(zmq::buffer(std::string(message)), zmq::send_flags::dontwait).has_value();
+	} catch (const zmq::error_t& error) {
+		return false;
+	}
+}
+
+bool Service::sendCancel(int jobId) {
+	auto id = std::to_string(jobId);
+	std::array<zmq::const_buffer, 2> frames = { zmq::str_buffer("cancel"), zmq::buffer(id) };
+	try {
+		return zmq::send_multipart(socket, frames, zmq::send_flags::dontwait).has_value();
+	} catch (const zmq::error_t& error) {
+		return false;
+	}
+}
+
+int Service::getActiveCount(int priority) {
+	return (int)std::count_if(sentJobs.begin(), sentJobs.end(), [priority](const DepthJob& sent) {
+		return !sent.refining && (priority < 0 || sent.priority == priority);
+	});
+}
+
+bool Service::checkProcess(std::string& failure) {
+	std::lock_guard lock(processMutex);
+	if (!Process::isValid(process)) return true;
+	std::vector<std::string> lines;
+	Process::readLines(process, lines);
+	for (const auto& line : lines) SDL_Log("DepthGenerate: %s", line.c_str());
+	auto exitCode = 0;
+	if (Process::isRunning(process, &exitCode)) return true;
+	Process::release(process);
+	failure = "Depth Service Exited with Code " + std::to_string(exitCode);
+	return false;
+}
+
+bool Service::waitForQuit() {
+	auto start = SDL_GetTicks();
+	while (SDL_GetTicks() - start < quitTimeout) {
+		zmq::pollitem_t items[] = { { socket.handle(), 0, ZMQ_POLLIN, 0 } };
+		try {
+			zmq::poll(items, 1, std::chrono::milliseconds(pollTimeout));
+			if (items[0].revents & ZMQ_POLLIN) {
+				while (receiveResult()) {}
+			}
+		} catch (const zmq::error_t& error) {
+			return false;
+		}
+		if (quitAcknowledged) return true;
+		std::string failure;
+		if (!checkProcess(failure)) return true;
+	}
+	return false;
+}
+
+int Service::pipeRun(void* ptr) {
+	auto waitStart = SDL_GetTicks();
+	Uint64 lastHello = 0;
+	auto lastHeartbeat = SDL_GetTicks();
+	lastMessage = SDL_GetTicks();
+	quitAcknowledged = false;
+	std::string failure;
+	while (pipeAlive) {
+		if (!checkProcess(failure)) break;
+
+		auto hasProcess = false;
+		{
+			std::lock_guard lock(processMutex);
+			hasProcess = Process::isValid(process);
+		}
+		auto now = SDL_GetTicks();
+		if (state != Service_Ready && !hasProcess && now - waitStart > daemonWait) {
+			failure = "Depth Service Did Not Start";
+			break;
+		}
+
+		if (!connected) {
+			std::string daemonEndpoint;
+			if (!readDaemon(daemonEndpoint)) {
+				SDL_Delay(daemonCheckDelay);
+				continue;
+			}
+			try {
+				socket.connect(daemonEndpoint);
+			} catch (const zmq::error_t& error) {
+				failure = "Could Not Connect Depth Service";
+				break;
+			}
+			endpoint = daemonEndpoint;
+			connected = true;
+		}
+
+		if (state != Service_Ready) {
+			if (now - lastHello >= helloInterval && sendControl("hello")) lastHello = now;
+		} else {
+			if (now - lastHeartbeat >= heartbeatInterval) {
+				lastHeartbeat = now;
+				sendControl("ping");
+			}
+			if (now - lastMessage > heartbeatTimeout) {
+				failure = "Depth Service Stopped Responding";
+				break;
+			}
+		}
+
+		while (state == Service_Ready) {
+			DepthJob job;
+			{
+				std::lock_guard lock(jobMutex);
+				if (queuedJobs.empty() || getActiveCount() >= maxInFlight) break;
+				auto next = std::min_element(queuedJobs.begin(), queuedJobs.end(),
+					[](const DepthJob& a, const DepthJob& b) {
+						return a.priority != b.priority ? a.priority < b.priority : a.id < b.id;
+					});
+				if (next->priority == Priority_Speculative &&
+					getActiveCount(Priority_Speculative) >= maxSpeculative) break;
+				job = *next;
+				job.sent = SDL_GetTicks();
+				queuedJobs.erase(next);
+				sentJobs.push_back(job);
+			}
+			if (!sendJob(job)) {
+				std::lock_guard lock(jobMutex);
+				std::erase_if(sentJobs, [&job](const DepthJob& sent) { return sent.id == job.id; });
+				queuedJobs.push_front(job);
+				break;
+			}
+		}
+
+		std::vector<int> cancelled;
+		{
+			std::lock_guard lock(jobMutex);
+			cancelled.swap(cancelledJobs);
+		}
+		for (auto jobId : cancelled) sendCancel(jobId);
+
+		zmq::pollitem_t items[] = { { socket.handle(), 0, ZMQ_POLLIN, 0 }, { telemetry.handle(), 0, ZMQ_POLLIN, 0 } };
+		try {
+			zmq::poll(items, telemetry.handle() ? 2 : 1, std::chrono::milliseconds(pollTimeout));
+			if (items[0].revents & ZMQ_POLLIN) {
+				while (receiveResult()) {}
+			}
+			if (telemetry.handle() && (items[1].revents & ZMQ_POLLIN)) {
+				while (receiveTelemetry()) {}
+			}
+		} catch (const zmq::error_t& error) {
+			failure = std::string("Depth Service Error: ") + error.what();
+			break;
+		}
+	}
+
+	if (!failure.empty()) {
+		SDL_Log("%s.", failure.c_str());
+		failPending(failure);
+		if (daemonMode && connected) removeDaemon(endpoint);
+	}
+	if (sendQuit && connected && failure.empty() && sendControl("quit") && !waitForQuit())
+		SDL_Log("Depth Service Did Not Acknowledge Quit.");
+	socket.close();
+	telemetry.close();
+	{
+		std::lock_guard lock(processMutex);
+		if (!daemonMode && Process::isValid(process)) Process::wait(process, quitTimeout);
+		Process::release(process);
+	}
+	state = Service_Stopped;
+	pipeAlive = false;
+	return 0;
+}
\ No newline at end of file
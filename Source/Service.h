@@ -0,0 +1,174 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RENDEPTH_SERVICE_H
+#define RENDEPTH_SERVICE_H
+
+#include "Process.h"
+#include <SDL3/SDL.h>
+#include <zmq.hpp>
+#include <atomic>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <deque>
+
+enum ServiceState {
+	Service_Stopped = 0,
+	Service_Starting = 1,
+	Service_Ready = 2
+};
+
+enum JobPriority {
+	Priority_Current = 0,
+	Priority_Speculative = 1
+};
+
+struct SharedBuffer {
+	std::string name;
+	Uint8* data;
+	size_t size;
+	void* handle;
+};
+
+struct DepthJob {
+	int id;
+	int imageId;
+	int priority;
+	std::string path;
+	Uint64 submitted;
+	Uint64 sent;
+	SharedBuffer buffer;
+	int width;
+	int height;
+	bool refining;
+};
+
+struct DepthResult {
+	int id;
+	int imageId;
+	int priority;
+	std::string path;
+	bool error;
+	Uint64 latency;
+	std::vector<Uint8> depth;
+	int depthWidth;
+	int depthHeight;
+	bool draft;
+	bool refined;
+	Uint64 queued;
+};
+
+struct StageMetric {
+	int count;
+	double total;
+	double peak;
+};
+
+class Service {
+public:
+	static int start();
+	static int launch(const std::string& program, const std::vector<std::string>& arguments);
+	static void stop(bool shutdown = false);
+	static void close();
+	static int submit(const std::string& path, int imageId, int priority = Priority_Current,
+		const SDL_Surface* color = nullptr);
+	static bool poll(DepthResult& result);
+	static void clear();
+	static bool promote(int imageId);
+	static void cancelSpeculative(const std::vector<int>& keepIds);
+	static void cancelRefinement(const std::vector<int>& keepIds);
+	static bool isPending(int imageId);
+	static int getPendingCount();
+	static bool isRunning();
+	static bool isReady();
+	static std::string getReadyInfo();
+	static int openSharedBuffer(SharedBuffer& buffer, const std::string& name, size_t size);
+	static void closeSharedBuffer(SharedBuffer& buffer);
+	static int writeMetrics(const std::filesystem::path& path);
+	inline static std::string endpoint;
+	inline static int maxInFlight = 3;
+	inline static int maxSpeculative = 1;
+	inline static int pollTimeout = 5;
+	inline static int lingerTime = 500;
+	inline static bool useSharedMemory = true;
+	inline static bool useDaemon = true;
+	inline static std::filesystem::path daemonFile;
+	inline static std::filesystem::path daemonLog;
+	inline static std::string daemonSettings;
+	inline static Uint64 daemonWait = 180000;
+	inline static Uint32 daemonCheckDelay = 100;
+	inline static Uint64 helloInterval = 500;
+	inline static Uint64 heartbeatInterval = 2000;
+	inline static Uint64 heartbeatTimeout = 15000;
+	inline static Uint32 quitTimeout = 2000;
+	inline static bool logTelemetry = true;
+	inline static std::filesystem::path metricsFile;
+private:
+	static std::filesystem::path getDaemonPath(const std::filesystem::path& path);
+	static bool readDaemon(std::string& daemonEndpoint);
+	static void removeDaemon(const std::string& daemonEndpoint);
+	static bool isProcessAlive(int processId);
+	static void failPending(const std::string& message);
+	static bool sendControl(const char* message);
+	static bool sendCancel(int jobId);
+	static int getActiveCount(int priority = -1);
+	static bool checkProcess(std::string& failure);
+	static bool waitForQuit();
+	static int createSharedBuffer(SharedBuffer& buffer, size_t size);
+	static void releaseSharedBuffer(SharedBuffer& buffer);
+	static int pipeRun(void* ptr);
+	static bool sendJob(const DepthJob& job);
+	static bool receiveResult();
+	static void connectTelemetry(const std::string& telemetryEndpoint);
+	static bool receiveTelemetry();
+	static void recordMetric(const std::string& name, double value);
+	inline static zmq::context_t context{1};
+	inline static zmq::socket_t socket{};
+	inline static zmq::socket_t telemetry{};
+	inline static std::string clientId;
+	inline static SDL_Thread* pipeThread = nullptr;
+	inline static std::atomic<bool> pipeAlive = false;
+	inline static std::atomic<bool> sendQuit = true;
+	inline static std::atomic<bool> quitAcknowledged = false;
+	inline static std::atomic<int> state = Service_Stopped;
+	inline static std::atomic<Uint64> lastMessage = 0;
+	inline static std::mutex infoMutex;
+	inline static std::string readyInfo;
+	inline static std::mutex processMutex;
+	inline static ProcessHandle process;
+	inline static bool daemonMode = false;
+	inline static bool connected = false;
+	inline static bool launched = false;
+	inline static std::mutex jobMutex;
+	inline static std::deque<DepthJob> queuedJobs;
+	inline static std::vector<DepthJob> sentJobs;
+	inline static std::deque<DepthResult> results;
+	inline static std::vector<int> cancelledJobs;
+	inline static int nextJobId = 0;
+	inline static std::mutex metricsMutex;
+	inline static std::map<std::string, StageMetric> metrics;
+	inline static std::string metricsDevice;
+	inline static int peakQueue = 0;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,295 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <SDL3/SDL.h>
+#include <SDL3_image/SDL_image.h>
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "Service.h"
+#include "Depth.h"
+#include "Jpeg.h"
+#include "Png.h"
+
+struct BenchConfig {
+	int jobs = 48;
+	int inFlight = 3;
+	int width = 1920;
+	int height = 1080;
+	bool shared = true;
+	int maxLatency = 0;
+	std::string standIn;
+	std::vector<std::string> standInArguments;
+};
+
+struct BenchStats {
+	int completed = 0;
+	int failed = 0;
+	double elapsed = 0.0;
+	Uint64 startup = 0;
+	Uint64 totalQueued = 0;
+	std::vector<Uint64> latencies;
+};
+
+static std::string getStandInPath() {
+	auto basePath = SDL_GetBasePath();
+#ifdef _WIN32
+	return std::string(basePath ? basePath : "") + "StandIn.exe";
+#else
+	return std::string(basePath ? basePath : "") + "StandIn";
+#endif
+}
+
+static Uint64 getPercentile(const std::vector<Uint64>& sorted, double percentile) {
+	if (sorted.empty()) return 0;
+	return sorted[std::min(sorted.size() - 1, (size_t)(percentile * (sorted.size() - 1) + 0.5))];
+}
+
+static SDL_Surface* createColorSurface(int width, int height) {
+	auto color = SDL_CreateSurface(width, height, SDL_PIXELFORMAT_ABGR8888);
+	if (color == nullptr) return nullptr;
+	for (auto y = 0; y < height; ++y) {
+		auto pixels = static_cast<Uint8*>(color->pixels) + (size_t)y * color->pitch;
+		for (auto x = 0; x < width; ++x, pixels += 4) {
+			pixels[0] = (Uint8)(255 * x / width);
+			pixels[1] = (Uint8)(255 * y / height);
+			pixels[2] = 128;
+			pixels[3] = 255;
+		}
+	}
+	return color;
+}
+
+static int runBenchmark(const std::string& label, const BenchConfig& config, const std::vector<std::string>& extra,
+	BenchStats& stats) {
+	Service::maxInFlight = config.inFlight;
+	Service::useDaemon = false;
+	Service::useSharedMemory = config.shared;
+	Service::logTelemetry = false;
+	if (Service::start() < 0) return -1;
+	auto arguments = config.standInArguments;
+	arguments.insert(arguments.end(), extra.begin(), extra.end());
+	arguments.insert(arguments.end(), { "--mode", "2", "--endpoint", Service::endpoint });
+	auto launchStart = SDL_GetTicks();
+	if (Service::launch(config.standIn, arguments) != 0) {
+		Service::stop();
+		return -1;
+	}
+	while (!Service::isReady()) {
+		if (!Service::isRunning()) return -1;
+		SDL_Delay(1);
+	}
+	stats.startup = SDL_GetTicks() - launchStart;
+
+	auto color = config.shared ? createColorSurface(config.width, config.height) : nullptr;
+	auto start = SDL_GetTicksNS();
+	for (auto i = 0; i < config.jobs; ++i)
+		Service::submit("Bench_" + std::to_string(i) + ".jpg", i, Priority_Current, color);
+
+	DepthResult result{};
+	while (stats.completed + stats.failed < config.jobs) {
+		auto received = false;
+		while (Service::poll(result)) {
+			received = true;
+			if (result.draft) continue;
+			if (result.error) {
+				++stats.failed;
+				continue;
+			}
+			++stats.completed;
+			stats.latencies.push_back(result.latency);
+			stats.totalQueued += result.queued;
+		}
+		if (!received && !Service::isRunning() && Service::getPendingCount() == 0) break;
+		SDL_Delay(1);
+	}
+	stats.elapsed = (double)(SDL_GetTicksNS() - start) / 1e9;
+	SDL_DestroySurface(color);
+	Service::stop();
+
+	std::sort(stats.latencies.begin(), stats.latencies.end());
+	auto meanLatency = 0.0;
+	for (auto latency : stats.latencies) meanLatency += (double)latency;
+	auto completed = std::max(stats.completed, 1);
+	SDL_Log("%s: %d Jobs in %.2fs, %.2f Jobs/s, Startup %llums.", label.c_str(), stats.completed,
+		stats.elapsed, stats.completed / stats.elapsed, (unsigned long long)stats.startup);
+	SDL_Log("%s: Latency Mean %.1fms, P50 %llums, P95 %llums, Max %llums, Queued %.1fms, %d Failed.",
+		label.c_str(), meanLatency / completed, (unsigned long long)getPercentile(stats.latencies, 0.5),
+		(unsigned long long)getPercentile(stats.latencies, 0.95),
+		(unsigned long long)getPercentile(stats.latencies, 1.0), (double)stats.totalQueued / completed,
+		stats.failed);
+	return 0;
+}
+
+static int runUpsampleBenchmark(int width, int height, int depthSize, int repeats) {
+	auto scale = std::min(1.0, (double)depthSize / std::min(width, height));
+	glm::ivec2 planeSize = { std::max((int)(width * scale + 0.5), 1), std::max((int)(height * scale + 0.5), 1) };
+	SDL_Surface* color = SDL_CreateSurface(width, height, SDL_PIXELFORMAT_ABGR8888);
+	SDL_Surface* target = SDL_CreateSurface(width * 2, height, SDL_PIXELFORMAT_ABGR8888);
+	if (color == nullptr || target == nullptr) {
+		SDL_DestroySurface(color);
+		SDL_DestroySurface(target);
+		return -1;
+	}
+	for (auto y = 0; y < height; ++y) {
+		auto pixels = static_cast<Uint8*>(color->pixels) + (size_t)y * color->pitch;
+		for (auto x = 0; x < width; ++x, pixels += 4) {
+			auto inside = (x - width / 2) * (x - width / 2) + (y - height / 2) * (y - height / 2) < height * height / 9;
+			auto level = (Uint8)((inside ? 190 : 60) + ((x * 7 + y * 13) & 15));
+			pixels[0] = pixels[1] = pixels[2] = level;
+			pixels[3] = 255;
+		}
+	}
+	std::vector<Uint8> depth((size_t)planeSize.x * planeSize.y);
+	for (auto v = 0; v < planeSize.y; ++v) {
+		for (auto u = 0; u < planeSize.x; ++u) {
+			auto x = (u + 0.5) * width / planeSize.x - width / 2.0;
+			auto y = (v + 0.5) * height / planeSize.y - height / 2.0;
+			depth[(size_t)v * planeSize.x + u] = (Uint8)(x * x + y * y < height * height / 9.0 ? 220 : 40 + 100 * v / planeSize.y);
+		}
+	}
+
+	Depth::upsample(color, depth, planeSize, target, width);
+	auto start = SDL_GetTicksNS();
+	for (auto i = 0; i < repeats; ++i) Depth::upsample(color, depth, planeSize, target, width);
+	auto elapsed = (double)(SDL_GetTicksNS() - start) / 1e6 / repeats;
+	SDL_Log("Depth Upsample %dx%d from %dx%d: %.1fms, Plane %.2fMB Instead of %.2fMB.", width, height,
+		planeSize.x, planeSize.y, elapsed, depth.size() / 1048576.0, (double)width * height / 1048576.0);
+	SDL_DestroySurface(color);
+	SDL_DestroySurface(target);
+	return 0;
+}
+
+static int runJpegBenchmark(int width, int height, int quality, int repeats) {
+	auto color = createColorSurface(width, height);
+	if (color == nullptr) return -1;
+	std::vector<Uint8> output;
+	double elapsed[2] = {};
+	for (auto pass = 0; pass < 2; ++pass) {
+		Jpeg::encodeThreads = pass == 0 ? 1 : 0;
+		Jpeg::stripeRows = pass == 0 ? height : 0;
+		if (Jpeg::encode(color, quality, output) != 0) {
+			SDL_DestroySurface(color);
+			return -1;
+		}
+		auto start = SDL_GetTicksNS();
+		for (auto i = 0; i < repeats; ++i) Jpeg::encode(color, quality, output);
+		elapsed[pass] = (double)(SDL_GetTicksNS() - start) / 1e6 / repeats;
+	}
+	Jpeg::encodeThreads = 0;
+	Jpeg::stripeRows = 0;
+	SDL_Log("JPEG Encode %dx%d at Quality %d: Single Thread %.1fms, Striped %.1fms, %.2fMB.", width, height,
+		quality, elapsed[0], elapsed[1], output.size() / 1048576.0);
+	SDL_DestroySurface(color);
+	return 0;
+}
+
+static int runPngBenchmark(int width, int height, int repeats) {
+	auto color = createColorSurface(width, height);
+	if (color == nullptr) return -1;
+	for (auto y = 0; y < height; ++y) {
+		auto pixels = static_cast<Uint8*>(color->pixels) + (size_t)y * color->pitch + (size_t)width / 2 * 4;
+		for (auto x = width / 2; x < width; ++x, pixels += 4) {
+			auto dx = x - width * 3 / 4, dy = y - height / 2;
+			pixels[0] = pixels[1] = pixels[2] = (Uint8)(dx * dx + dy * dy < height * height / 9 ? 220 : 40 + 100 * y / height);
+		}
+	}
+	std::vector<Uint8> output;
+	if (Png::encode(color, output) != 0) {
+		SDL_DestroySurface(color);
+		return -1;
+	}
+	auto start = SDL_GetTicksNS();
+	for (auto i = 0; i < repeats; ++i) Png::encode(color, output);
+	auto elapsed = (double)(SDL_GetTicksNS() - start) / 1e6 / repeats;
+
+	auto path = std::filesystem::temp_directory_path() / "RendepthBenchmark.png";
+	start = SDL_GetTicksNS();
+	for (auto i = 0; i < repeats; ++i) IMG_SavePNG(color, path.string().c_str());
+	auto reference = (double)(SDL_GetTicksNS() - start) / 1e6 / repeats;
+	std::error_code errorCode;
+	auto referenceSize = (double)std::filesystem::file_size(path, errorCode);
+	std::filesystem::remove(path, errorCode);
+
+	auto rawSize = (double)width * height * 3;
+	SDL_Log("PNG Encode %dx%d: Fast %.1fms, %.1fMB/s, Ratio %.2f. IMG_SavePNG %.1fms, %.1fMB/s, Ratio %.2f.",
+		width, height, elapsed, rawSize / 1048.576 / elapsed, rawSize / output.size(), reference,
+		rawSize / 1048.576 / reference, referenceSize > 0 ? rawSize / referenceSize : 0.0);
+	SDL_DestroySurface(color);
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	BenchConfig config{};
+	config.standIn = getStandInPath();
+	auto depthSize = 720;
+	auto repeats = 5;
+	auto quality = 65;
+	for (auto i = 1; i + 1 < argc; i += 2) {
+		std::string key = argv[i];
+		std::string text = argv[i + 1];
+		auto value = std::atoi(text.c_str());
+		if (key == "--jobs") config.jobs = std::max(value, 1);
+		else if (key == "--inflight") config.inFlight = std::max(value, 1);
+		else if (key == "--width") config.width = std::max(value, 1);
+		else if (key == "--height") config.height = std::max(value, 1);
+		else if (key == "--shared") config.shared = value != 0;
+		else if (key == "--standin") config.standIn = text;
+		else if (key == "--max-latency") config.maxLatency = std::max(value, 0);
+		else if (key == "--metrics") Service::metricsFile = text;
+		else if (key == "--depth") depthSize = std::max(value, 1);
+		else if (key == "--repeat") repeats = std::max(value, 1);
+		else if (key == "--quality") quality = std::clamp(value, 1, 100);
+		else if (key == "--load" || key == "--infer" || key == "--write" || key == "--jitter" ||
+			key == "--fail" || key == "--seed" || key == "--crash" || key == "--stall") config.standInArguments.insert(config.standInArguments.end(),
+				{ key, text });
+	}
+
+	SDL_Log("Depth Service Benchmark - Stand-In: %s, %d Jobs, %dx%d, Shared Memory: %s.", config.standIn.c_str(),
+		config.jobs, config.width, config.height, config.shared ? "On" : "Off");
+
+	auto serial = config;
+	serial.inFlight = 1;
+	BenchStats serialStats, pipelinedStats;
+	if (runBenchmark("Single Request", serial, { "--serial", "1" }, serialStats) != 0) return 1;
+	if (runBenchmark("Pipelined x" + std::to_string(config.inFlight), config, {}, pipelinedStats) != 0) return 1;
+
+	Service::close();
+
+	if (pipelinedStats.completed + pipelinedStats.failed < config.jobs) {
+		SDL_Log("Depth Service Lost %d Jobs.", config.jobs - pipelinedStats.completed - pipelinedStats.failed);
+		return 2;
+	}
+	auto worstLatency = getPercentile(pipelinedStats.latencies, 0.95);
+	if (config.maxLatency > 0 && worstLatency > (Uint64)config.maxLatency) {
+		SDL_Log("P95 Latency %llums Exceeds %dms.", (unsigned long long)worstLatency, config.maxLatency);
+		return 2;
+	}
+
+	if (runUpsampleBenchmark(3840, 2160, depthSize, repeats) != 0) return 1;
+	if (runUpsampleBenchmark(7680, 4320, depthSize, repeats) != 0) return 1;
+	if (runJpegBenchmark(7680, 4320, quality, repeats) != 0) return 1;
+	if (runJpegBenchmark(11520, 8640, quality, std::max(repeats / 2, 1)) != 0) return 1;
+	if (runPngBenchmark(3840, 1080, repeats) != 0) return 1;
+	if (runPngBenchmark(7680, 2160, repeats) != 0) return 1;
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,475 @@
+// Copyright (c) 2025 Outmode
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include <SDL3/SDL.h>
+#include <zmq.hpp>
+#include <zmq_addon.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "Service.h"
+
+struct StandInJob {
+	std::string peer;
+	std::string id;
+	int priority;
+	int sequence;
+	std::string path;
+	std::string shared;
+	bool refine;
+	bool quit;
+	double decodeTime;
+	double inferTime;
+};
+
+struct StandInReply {
+	std::string peer;
+	std::string id;
+	std::string type;
+	std::string result;
+	bool draft;
+	bool counted;
+	std::string telemetry;
+};
+
+struct StandInConfig {
+	int mode = 2;
+	int model = 0;
+	int depthSize = 540;
+	int upscaleSize = 1920;
+	int maxSize = 4096;
+	int idleTime = 600;
+	std::string endpoint;
+	std::filesystem::path home;
+	int loadTime = 10;
+	int inferTime = 40;
+	int writeTime = 25;
+	int refineTime = 120;
+	int jitter = 0;
+	int failRate = 0;
+	int crashAfter = 0;
+	int stallAfter = 0;
+	bool pipelined = true;
+	unsigned int seed = 1;
+	int outputWidth = 640;
+	int outputHeight = 360;
+};
+
+template <typename T>
+class Channel {
+public:
+	void push(T item) {
+		{
+			std::lock_guard lock(mutex);
+			items.push_back(std::move(item));
+		}
+		ready.notify_one();
+	}
+	T pop() {
+		std::unique_lock lock(mutex);
+		ready.wait(lock, [this]() { return !items.empty(); });
+		auto item = std::move(items.front());
+		items.pop_front();
+		return item;
+	}
+	template <typename Less>
+	T popMin(Less less) {
+		std::unique_lock lock(mutex);
+		ready.wait(lock, [this]() { return !items.empty(); });
+		auto next = std::min_element(items.begin(), items.end(), less);
+		auto item = std::move(*next);
+		items.erase(next);
+		return item;
+	}
+	std::optional<T> tryPop() {
+		std::lock_guard lock(mutex);
+		if (items.empty()) return std::nullopt;
+		auto item = std::move(items.front());
+		items.pop_front();
+		return item;
+	}
+private:
+	std::mutex mutex;
+	std::condition_variable ready;
+	std::deque<T> items;
+};
+
+static std::vector<std::string> modelLabels = { "Small", "Base", "Large", "Progressive" };
+static const Uint64 clientTimeout = 15000;
+static StandInConfig config{};
+static Channel<StandInJob> jobs;
+static Channel<StandInJob> writes;
+static Channel<StandInReply> replies;
+static std::mutex cancelMutex;
+static std::set<std::pair<std::string, std::string>> cancelled;
+static std::mutex randomMutex;
+static std::mt19937 generator;
+
+static int getProcessId() {
+#ifdef _WIN32
+	return (int)GetCurrentProcessId();
+#else
+	return (int)getpid();
+#endif
+}
+
+static std::string getSettings() {
+	return std::to_string(config.model) + " " + std::to_string(config.depthSize) + " " +
+		std::to_string(config.upscaleSize) + " " + std::to_string(config.maxSize);
+}
+
+static bool isProgressive() {
+	return config.model == 3 && (config.mode == 2 || config.mode == 4);
+}
+
+static int getRandom(int limit) {
+	std::lock_guard lock(randomMutex);
+	return std::uniform_int_distribution(0, limit)(generator);
+}
+
+static double sleepFor(int milliseconds) {
+	if (milliseconds <= 0) return 0.0;
+	auto start = SDL_GetTicksNS();
+	if (config.jitter > 0) milliseconds += getRandom(config.jitter);
+	std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+	return (double)(SDL_GetTicksNS() - start) / 1e6;
+}
+
+static bool injectFailure() {
+	return config.failRate > 0 && getRandom(99) < config.failRate;
+}
+
+static bool takeCancelled(const StandInJob& job) {
+	std::lock_guard lock(cancelMutex);
+	return cancelled.erase({ job.peer, job.id }) > 0;
+}
+
+static Uint8 getSyntheticDepth(int x, int y, int width, int height, int luma) {
+	auto dx = (x + 0.5) / width - 0.5;
+	auto dy = (y + 0.5) / height - 0.5;
+	auto center = std::max(0.0, 1.0 - (dx * dx + dy * dy) * 4.0);
+	auto vertical = (double)y / std::max(height - 1, 1);
+	return (Uint8)std::clamp(255.0 * (vertical * 0.4 + center * 0.4) + luma * 0.2, 0.0, 255.0);
+}
+
+static StandInReply writeShared(const StandInJob& job) {
+	char name[256] = {};
+	auto width = 0, height = 0;
+	if (std::sscanf(job.shared.c_str(), "%255s %d %d", name, &width, &height) != 3 || width <= 0 || height <= 0)
+		return { job.peer, job.id, "error", "ERROR" };
+	SharedBuffer buffer{};
+	if (Service::openSharedBuffer(buffer, name, (size_t)width * height * 5) != 0)
+		return { job.peer, job.id, "error", "ERROR" };
+
+	auto scale = std::min(1.0, (double)config.depthSize / std::min(width, height));
+	auto planeWidth = std::max((int)(width * scale + 0.5), 1);
+	auto planeHeight = std::max((int)(height * scale + 0.5), 1);
+	auto plane = buffer.data + (size_t)width * height * 4;
+	for (auto y = 0; y < planeHeight; ++y) {
+		auto row = buffer.data + (size_t)(y * height / planeHeight) * width * 4;
+		for (auto x = 0; x < planeWidth; ++x) {
+			auto pixel = row + (size_t)(x * width / planeWidth) * 4;
+			auto luma = (pixel[0] * 77 + pixel[1] * 150 + pixel[2] * 29) >> 8;
+			plane[(size_t)y * planeWidth + x] = getSyntheticDepth(x, y, planeWidth, planeHeight, luma);
+		}
+	}
+	Service::closeSharedBuffer(buffer);
+	return { job.peer, job.id, "depth", std::to_string(planeWidth) + "x" + std::to_string(planeHeight) };
+}
+
+static StandInReply writeFile(const StandInJob& job) {
+	auto tempPath = (config.home.empty() ? std::filesystem::temp_directory_path() : config.home) / "Temp";
+	std::error_code error;
+	std::filesystem::create_directories(tempPath, error);
+	auto outputPath = tempPath / (std::filesystem::path(job.path).stem().string() +
+		(job.refine ? "_refined_rgbd.bmp" : "_rgbd.bmp"));
+
+	auto width = config.outputWidth, height = config.outputHeight;
+	auto surface = SDL_CreateSurface(width * 2, height, SDL_PIXELFORMAT_ABGR8888);
+	if (surface == nullptr) return { job.peer, job.id, "error", "ERROR" };
+	for (auto y = 0; y < height; ++y) {
+		auto pixels = static_cast<Uint8*>(surface->pixels) + (size_t)y * surface->pitch;
+		for (auto x = 0; x < width; ++x) {
+			auto color = (Uint8)(64 + 128 * x / width);
+			auto depth = getSyntheticDepth(x, y, width, height, color);
+			auto left = pixels + (size_t)x * 4, right = pixels + (size_t)(x + width) * 4;
+			left[0] = color;
+			left[1] = (Uint8)(64 + 128 * y / height);
+			left[2] = 160;
+			right[0] = right[1] = right[2] = depth;
+			left[3] = right[3] = 255;
+		}
+	}
+	auto saved = SDL_SaveBMP(surface, outputPath.string().c_str());
+	SDL_DestroySurface(surface);
+	if (!saved) return { job.peer, job.id, "error", "ERROR" };
+	return { job.peer, job.id, "done", outputPath.string() };
+}
+
+static std::string getTelemetry(const StandInJob& job, double encodeTime) {
+	char text[256];
+	std::snprintf(text, sizeof text, "{\"id\": %d, \"stage\": \"done\", \"timings\": {\"decode\": %.2f, "
+		"\"infer\": %.2f, \"encode\": %.2f}, \"queue\": 0, \"device\": \"Stand-In\", \"refine\": %s}",
+		std::atoi(job.id.c_str()), job.decodeTime, job.inferTime, encodeTime, job.refine ? "true" : "false");
+	return text;
+}
+
+static void writeJob(const StandInJob& job) {
+	auto encodeTime = sleepFor(config.writeTime);
+	auto draft = isProgressive() && !job.refine;
+	auto reply = injectFailure() ? StandInReply{ job.peer, job.id, "error", "ERROR" } :
+		job.shared.empty() ? writeFile(job) : writeShared(job);
+	if (draft && reply.type == "error") return;
+	reply.draft = draft;
+	reply.counted = !draft;
+	reply.telemetry = getTelemetry(job, encodeTime);
+	replies.push(reply);
+}
+
+static void inferRun() {
+	auto less = [](const StandInJob& a, const StandInJob& b) {
+		return a.priority != b.priority ? a.priority < b.priority : a.sequence < b.sequence;
+	};
+	while (true) {
+		auto job = jobs.popMin(less);
+		if (job.quit) {
+			writes.push(job);
+			return;
+		}
+		if (job.refine && takeCancelled(job)) {
+			replies.push({ job.peer, job.id, {}, {}, false, true });
+			continue;
+		}
+		job.decodeTime = sleepFor(config.loadTime);
+		job.inferTime = sleepFor(job.refine ? config.refineTime : config.inferTime);
+		if (config.pipelined) writes.push(job);
+		else writeJob(job);
+		if (isProgressive() && !job.refine) {
+			auto refine = job;
+			refine.priority += 2;
+			refine.refine = true;
+			jobs.push(refine);
+		}
+	}
+}
+
+static void writeRun() {
+	while (true) {
+		auto job = writes.pop();
+		if (job.quit) return;
+		writeJob(job);
+	}
+}
+
+static std::filesystem::path getServiceFile() {
+	auto key = getSettings();
+	std::replace(key.begin(), key.end(), ' ', '_');
+	return config.home / ("Service_" + key + ".json");
+}
+
+static void publishService(const std::string& endpoint) {
+	auto servicePath = getServiceFile();
+	auto tempPath = servicePath;
+	tempPath += "." + std::to_string(getProcessId());
+	{
+		std::ofstream file(tempPath);
+		file << "{\"endpoint\": \"" << endpoint << "\", \"pid\": " << getProcessId() <<
+			", \"settings\": \"" << getSettings() << "\"}";
+	}
+	std::error_code error;
+	std::filesystem::rename(tempPath, servicePath, error);
+	SDL_Log("Stand-In Service Listening on %s.", endpoint.c_str());
+}
+
+static void withdrawService() {
+	std::ifstream file(getServiceFile());
+	std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	file.close();
+	if (text.find("\"pid\": " + std::to_string(getProcessId()) + ",") == std::string::npos) return;
+	std::error_code error;
+	std::filesystem::remove(getServiceFile(), error);
+}
+
+static void sendFrames(zmq::socket_t& router, const std::vector<std::string>& frames) {
+	std::vector<zmq::const_buffer> buffers;
+	for (const auto& frame : frames) buffers.push_back(zmq::buffer(frame));
+	zmq::send_multipart(router, buffers, zmq::send_flags::dontwait);
+}
+
+static int serviceRun() {
+	zmq::context_t context{1};
+	zmq::socket_t router(context, zmq::socket_type::router);
+	zmq::socket_t telemetry(context, zmq::socket_type::pub);
+	router.set(zmq::sockopt::linger, 200);
+	telemetry.set(zmq::sockopt::linger, 0);
+	std::string endpoint = config.endpoint;
+	std::string telemetryEndpoint;
+	try {
+		telemetry.bind("tcp://127.0.0.1:*");
+		telemetryEndpoint = telemetry.get(zmq::sockopt::last_endpoint);
+		if (config.mode == 4) {
+			router.bind("tcp://127.0.0.1:*");
+			endpoint = router.get(zmq::sockopt::last_endpoint);
+			publishService(endpoint);
+		} else {
+			router.connect(endpoint);
+		}
+	} catch (const zmq::error_t& error) {
+		SDL_Log("Stand-In Could Not Open %s: %s", endpoint.c_str(), error.what());
+		return 1;
+	}
+
+	std::thread inferThread(inferRun);
+	std::thread writeThread(writeRun);
+	auto label = modelLabels[config.model];
+	auto sequence = 0;
+	auto outstanding = 0;
+	auto received = 0;
+	auto lastActivity = SDL_GetTicks();
+	auto running = true;
+	std::string quitPeer;
+	std::map<std::string, Uint64> clients;
+	while (running) {
+		zmq::pollitem_t items[] = { { router.handle(), 0, ZMQ_POLLIN, 0 } };
+		zmq::poll(items, 1, std::chrono::milliseconds(5));
+		auto stalled = config.stallAfter > 0 && received >= config.stallAfter;
+		while (items[0].revents & ZMQ_POLLIN) {
+			std::vector<zmq::message_t> frames;
+			if (!zmq::recv_multipart(router, std::back_inserter(frames), zmq::recv_flags::dontwait)) break;
+			if (frames.size() < 2 || stalled) continue;
+			auto peer = frames[0].to_string();
+			auto type = frames[1].to_string();
+			lastActivity = SDL_GetTicks();
+			clients[peer] = lastActivity;
+			if (type == "hello") sendFrames(router, { peer, "ready", label, "Stand-In", getSettings(), telemetryEndpoint });
+			if (type == "ping") sendFrames(router, { peer, "pong" });
+			if (type == "cancel" && frames.size() >= 3) {
+				std::lock_guard lock(cancelMutex);
+				cancelled.insert({ peer, frames[2].to_string() });
+			}
+			if (type == "quit") {
+				clients.erase(peer);
+				auto active = std::count_if(clients.begin(), clients.end(), [&](const auto& client) {
+					return lastActivity - client.second < clientTimeout;
+				});
+				if (config.mode == 4 && active > 0) {
+					SDL_Log("Stand-In Keeping Service for %d Other Clients.", (int)active);
+					sendFrames(router, { peer, "bye" });
+					continue;
+				}
+				quitPeer = peer;
+				running = false;
+				break;
+			}
+			if (type == "job" && frames.size() >= 5) {
+				auto shared = frames.size() >= 6 ? frames[5].to_string() : std::string();
+				jobs.push({ peer, frames[2].to_string(), std::atoi(frames[3].to_string().c_str()), ++sequence,
+					frames[4].to_string(), shared, false, false, 0.0, 0.0 });
+				++outstanding;
+				++received;
+				if (config.crashAfter > 0 && received >= config.crashAfter) {
+					SDL_Log("Stand-In Crashing After %d Jobs.", received);
+					std::_Exit(3);
+				}
+			}
+		}
+		while (auto reply = replies.tryPop()) {
+			if (reply->counted) --outstanding;
+			if (reply->type.empty() || stalled) continue;
+			std::vector<std::string> frames = { reply->peer, reply->type, reply->id, reply->result };
+			if (reply->draft) frames.push_back("refine");
+			sendFrames(router, frames);
+			if (!reply->telemetry.empty()) sendFrames(telemetry, { reply->peer, reply->telemetry });
+			lastActivity = SDL_GetTicks();
+		}
+		if (config.mode == 4 && outstanding <= 0 && SDL_GetTicks() - lastActivity > (Uint64)config.idleTime * 1000) {
+			SDL_Log("Stand-In Idle for %d Seconds.", config.idleTime);
+			running = false;
+		}
+	}
+
+	jobs.push({ {}, {}, -1, -1, {}, {}, false, true, 0.0, 0.0 });
+	inferThread.join();
+	writeThread.join();
+	if (!quitPeer.empty()) sendFrames(router, { quitPeer, "bye" });
+	if (config.mode == 4) withdrawService();
+	router.close();
+	telemetry.close();
+	context.close();
+	return 0;
+}
+
+int main(int argc, char** argv) {
+	std::map<std::string, int*> values = {
+		{ "--model", &config.model }, { "--depth", &config.depthSize }, { "--upscale", &config.upscaleSize },
+		{ "--maxsize", &config.maxSize }, { "--mode", &config.mode }, { "--idle", &config.idleTime },
+		{ "--load", &config.loadTime }, { "--infer", &config.inferTime }, { "--write", &config.writeTime },
+		{ "--refine", &config.refineTime }, { "--jitter", &config.jitter }, { "--fail", &config.failRate },
+		{ "--crash", &config.crashAfter }, { "--stall", &config.stallAfter },
+		{ "--width", &config.outputWidth }, { "--height", &config.outputHeight }
+	};
+	for (auto i = 1; i + 1 < argc; i += 2) {
+		std::string key = argv[i];
+		std::string value = argv[i + 1];
+		if (values.contains(key)) *values[key] = std::atoi(value.c_str());
+		else if (key == "--endpoint") config.endpoint = value;
+		else if (key == "--home") config.home = value;
+		else if (key == "--serial") config.pipelined = std::atoi(value.c_str()) == 0;
+		else if (key == "--seed") config.seed = (unsigned int)std::atoi(value.c_str());
+	}
+	config.model = std::clamp(config.model, 0, 3);
+	config.depthSize = std::max(config.depthSize, 1);
+	config.outputWidth = std::max(config.outputWidth, 1);
+	config.outputHeight = std::max(config.outputHeight, 1);
+	generator.seed(config.seed);
+
+	if (config.mode != 2 && config.mode != 4) {
+		SDL_Log("Stand-In Only Supports Service Modes 2 and 4.");
+		return 1;
+	}
+	if ((config.mode == 2 && config.endpoint.empty()) || (config.mode == 4 && config.home.empty())) {
+		SDL_Log("Stand-In Needs '--endpoint' in Mode 2 or '--home' in Mode 4.");
+		return 1;
+	}
+	SDL_Log("Stand-In Started - Load: %dms, Infer: %dms, Write: %dms, Jitter: %dms, Fail: %d%%.",
+		config.loadTime, config.inferTime, config.writeTime, config.jitter, config.failRate);
+	return serviceRun();
+}
\ No newline at end of file